@@ -0,0 +1,109 @@
+#include "Saturn/Defines.h"
+#include "Saturn/Log.h"
+
+import Saturn.Benchmark;
+
+import <cstdio>;
+import <chrono>;
+import <string>;
+import <vector>;
+import <numeric>;
+import <fstream>;
+import <algorithm>;
+
+static double Percentile(const std::vector<double>& SortedSamples, double Fraction) {
+    size_t Rank = static_cast<size_t>(Fraction * (SortedSamples.size() - 1) + 0.5);
+    return SortedSamples[std::min(Rank, SortedSamples.size() - 1)];
+}
+
+double FBenchmarkResult::GetBytesPerSecond() const {
+    return P50Ns > 0 ? BytesPerIteration * 1e9 / P50Ns : 0;
+}
+
+double FBenchmarkResult::GetItemsPerSecond() const {
+    return P50Ns > 0 ? ItemsPerIteration * 1e9 / P50Ns : 0;
+}
+
+FBenchmarkRunner::FBenchmarkRunner(uint32_t InIterations, uint32_t InWarmupIterations, const std::string& InFilter)
+    : Iterations(std::max(InIterations, 1u)), WarmupIterations(InWarmupIterations), Filter(InFilter) {}
+
+bool FBenchmarkRunner::IsFiltered(const std::string& Name) const {
+    return !Filter.empty() && Name.find(Filter) == std::string::npos;
+}
+
+void FBenchmarkRunner::Run(const FBenchmarkCase& Case) {
+    if (IsFiltered(Case.Name)) {
+        return;
+    }
+
+    LOG_INFO("Running {0} ({1} iterations)", Case.Name, Iterations);
+
+    for (uint32_t i = 0; i < WarmupIterations; i++) {
+        if (Case.Setup) Case.Setup();
+        if (!Case.Body()) {
+            LOG_ERROR("Benchmark {0} failed during warmup, skipping it", Case.Name);
+            return;
+        }
+    }
+
+    std::vector<double> Samples;
+    Samples.reserve(Iterations);
+
+    for (uint32_t i = 0; i < Iterations; i++) {
+        if (Case.Setup) Case.Setup();
+
+        auto Start = std::chrono::steady_clock::now();
+        bool bSucceeded = Case.Body();
+        auto End = std::chrono::steady_clock::now();
+
+        if (!bSucceeded) {
+            LOG_ERROR("Benchmark {0} failed on iteration {1}, skipping it", Case.Name, i);
+            return;
+        }
+        Samples.push_back(std::chrono::duration<double, std::nano>(End - Start).count());
+    }
+
+    std::sort(Samples.begin(), Samples.end());
+
+    FBenchmarkResult Result;
+    Result.Name = Case.Name;
+    Result.Iterations = Iterations;
+    Result.BytesPerIteration = Case.Bytes;
+    Result.ItemsPerIteration = Case.Items;
+    Result.MinNs = Samples.front();
+    Result.MeanNs = std::accumulate(Samples.begin(), Samples.end(), 0.0) / Samples.size();
+    Result.P50Ns = Percentile(Samples, 0.50);
+    Result.P90Ns = Percentile(Samples, 0.90);
+    Result.P99Ns = Percentile(Samples, 0.99);
+    Result.MaxNs = Samples.back();
+
+    Results.push_back(Result);
+}
+
+void FBenchmarkRunner::PrintResults() const {
+    std::printf("\n%-28s %6s %11s %11s %11s %11s %11s %11s %13s\n", "Benchmark", "Iters", "Min (ms)", "Mean (ms)", "P50 (ms)", "P90 (ms)", "P99 (ms)", "MB/s", "Items/s");
+
+    for (const FBenchmarkResult& Result : Results) {
+        std::printf("%-28s %6u %11.3f %11.3f %11.3f %11.3f %11.3f %11.1f %13.0f\n",
+            Result.Name.c_str(), Result.Iterations,
+            Result.MinNs / 1e6, Result.MeanNs / 1e6, Result.P50Ns / 1e6, Result.P90Ns / 1e6, Result.P99Ns / 1e6,
+            Result.GetBytesPerSecond() / (1024.0 * 1024.0), Result.GetItemsPerSecond());
+    }
+}
+
+bool FBenchmarkRunner::WriteCsv(const std::string& Path) const {
+    std::ofstream Out(Path);
+    if (!Out) {
+        LOG_ERROR("Failed to open {0} for writing", Path);
+        return false;
+    }
+
+    Out << "name,iterations,bytes,items,min_ns,mean_ns,p50_ns,p90_ns,p99_ns,max_ns,bytes_per_sec,items_per_sec\n";
+    for (const FBenchmarkResult& Result : Results) {
+        Out << Result.Name << ',' << Result.Iterations << ',' << Result.BytesPerIteration << ',' << Result.ItemsPerIteration << ','
+            << Result.MinNs << ',' << Result.MeanNs << ',' << Result.P50Ns << ',' << Result.P90Ns << ',' << Result.P99Ns << ',' << Result.MaxNs << ','
+            << Result.GetBytesPerSecond() << ',' << Result.GetItemsPerSecond() << '\n';
+    }
+
+    return true;
+}
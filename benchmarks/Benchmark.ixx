@@ -0,0 +1,62 @@
+module;
+
+#include "Saturn/Defines.h"
+
+export module Saturn.Benchmark;
+
+import <string>;
+import <vector>;
+import <cstdint>;
+import <functional>;
+
+// Timing summary of one benchmark case, all times are in nanoseconds
+export struct FBenchmarkResult {
+    std::string Name;
+    uint32_t Iterations = 0;
+    uint64_t BytesPerIteration = 0;
+    uint64_t ItemsPerIteration = 0;
+
+    double MinNs = 0;
+    double MeanNs = 0;
+    double P50Ns = 0;
+    double P90Ns = 0;
+    double P99Ns = 0;
+    double MaxNs = 0;
+
+    // Throughput at the median iteration time, 0 if the case doesn't report bytes/items
+    double GetBytesPerSecond() const;
+    double GetItemsPerSecond() const;
+};
+
+export struct FBenchmarkCase {
+    std::string Name;
+
+    // Work done by one iteration, only used to derive throughput
+    uint64_t Bytes = 0;
+    uint64_t Items = 0;
+
+    // Runs before every iteration and is not timed, e.g. to drop caches
+    std::function<void()> Setup;
+
+    // The timed part, returning false aborts the case
+    std::function<bool()> Body;
+};
+
+export class FBenchmarkRunner {
+public:
+    FBenchmarkRunner(uint32_t InIterations, uint32_t InWarmupIterations, const std::string& InFilter);
+
+    // Runs the case unless it is filtered out, a failing case is logged and skipped
+    void Run(const FBenchmarkCase& Case);
+    bool IsFiltered(const std::string& Name) const;
+
+    void PrintResults() const;
+    bool WriteCsv(const std::string& Path) const;
+
+    const std::vector<FBenchmarkResult>& GetResults() const { return Results; }
+private:
+    uint32_t Iterations;
+    uint32_t WarmupIterations;
+    std::string Filter;
+    std::vector<FBenchmarkResult> Results;
+};
@@ -0,0 +1,2 @@
+// The app gets miniz from the zip download helpers, which the benchmark doesn't build
+#include <miniz/zip_file.hpp>
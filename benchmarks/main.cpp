@@ -0,0 +1,561 @@
+#include "Saturn/Defines.h"
+#include "Saturn/Log.h"
+
+#include <xxhash/xxhash.h>
+
+import <string>;
+import <vector>;
+import <cstdio>;
+import <cstdint>;
+import <cstdlib>;
+import <sstream>;
+import <memory>;
+import <algorithm>;
+import <filesystem>;
+
+import Saturn.Benchmark;
+import Saturn.Structs.Guid;
+import Saturn.Misc.IoBuffer;
+import Saturn.Core.IoStatus;
+import Saturn.Asset.NameMap;
+import Saturn.Encryption.AES;
+import Saturn.VFS.FileSystem;
+import Saturn.Compression.Oodle;
+import Saturn.Misc.IoReadOptions;
+import Saturn.Structs.IoChunkId;
+import Saturn.Files.FileProvider;
+import Saturn.Readers.MemoryReader;
+import Saturn.IoStore.IoBlockCache;
+import Saturn.IoStore.IoStoreReader;
+import Saturn.Readers.AsyncReadBackend;
+import Saturn.Asset.ExportMapEntry;
+import Saturn.Asset.ExportBundleEntry;
+import Saturn.Readers.ZenPackageReader;
+import Saturn.ZenPackage.ZenPackageSummary;
+import Saturn.Structs.IoStoreTocResource;
+import Saturn.Unversioned.UnversionedHeader;
+
+struct FBenchmarkOptions {
+    std::string PakDirectory;
+    std::string MappingsFile;
+    std::string AESKey;
+    std::string OodleDll = "oo2core_9_win64.dll";
+    std::string PackagePath;
+    std::string Filter;
+    std::string CsvPath;
+    std::string SnapshotPath;
+    FAsyncReadBackendSettings ReadBackend;
+    uint32_t Iterations = 20;
+    uint32_t WarmupIterations = 2;
+    uint32_t ChunkSampleCount = 256;
+};
+
+static void PrintUsage() {
+    std::printf(
+        "Usage: SaturnBenchmark <PakDirectory> <MappingsFile> [options]\n"
+        "  --key <hex>          Main AES key, needed for encrypted containers\n"
+        "  --oodle <path>       Oodle library to load (default oo2core_9_win64.dll)\n"
+        "  --package <path>     Package used by the package level benchmarks, e.g. FortniteGame/Content/Athena/...uasset\n"
+        "  --iterations <n>     Timed iterations per benchmark (default 20)\n"
+        "  --warmup <n>         Untimed iterations per benchmark (default 2)\n"
+        "  --chunks <n>         Number of chunks read per chunk read iteration (default 256)\n"
+        "  --filter <text>      Only run benchmarks whose name contains the text\n"
+        "  --csv <path>         Also write the results as csv\n"
+        "  --snapshot <path>    Mount snapshot file, enables the MountFromSnapshot benchmark\n"
+        "  --io-backend <name>  Async container read backend, threadpool or iouring (default iouring on Linux)\n"
+        "  --queue-depth <n>    Reads the iouring backend keeps in flight (default 128)\n");
+}
+
+static bool ParseOptions(int argc, char* argv[], FBenchmarkOptions& Options) {
+    if (argc < 3) {
+        return false;
+    }
+
+    Options.PakDirectory = argv[1];
+    Options.MappingsFile = argv[2];
+
+    for (int i = 3; i < argc; i++) {
+        std::string Arg = argv[i];
+        if (i + 1 >= argc) {
+            return false;
+        }
+
+        std::string Value = argv[++i];
+        if (Arg == "--key") Options.AESKey = Value;
+        else if (Arg == "--oodle") Options.OodleDll = Value;
+        else if (Arg == "--package") Options.PackagePath = Value;
+        else if (Arg == "--iterations") Options.Iterations = std::strtoul(Value.c_str(), nullptr, 10);
+        else if (Arg == "--warmup") Options.WarmupIterations = std::strtoul(Value.c_str(), nullptr, 10);
+        else if (Arg == "--chunks") Options.ChunkSampleCount = std::strtoul(Value.c_str(), nullptr, 10);
+        else if (Arg == "--filter") Options.Filter = Value;
+        else if (Arg == "--csv") Options.CsvPath = Value;
+        else if (Arg == "--snapshot") Options.SnapshotPath = Value;
+        else if (Arg == "--io-backend" && Value == "threadpool") Options.ReadBackend.Backend = EAsyncReadBackend::ThreadPool;
+        else if (Arg == "--io-backend" && Value == "iouring") Options.ReadBackend.Backend = EAsyncReadBackend::IoUring;
+        else if (Arg == "--queue-depth") Options.ReadBackend.QueueDepth = std::strtoul(Value.c_str(), nullptr, 10);
+        else return false;
+    }
+
+    return true;
+}
+
+// The largest container gives the most stable numbers for the per-container benchmarks
+static std::string FindLargestContainer(const std::string& PakDirectory) {
+    std::string Largest;
+    uintmax_t LargestSize = 0;
+
+    std::error_code Code;
+    for (auto& File : std::filesystem::directory_iterator(PakDirectory, Code)) {
+        if (File.path().extension() != ".utoc") continue;
+
+        uintmax_t Size = File.file_size(Code);
+        if (Size > LargestSize) {
+            LargestSize = Size;
+            Largest = File.path().string();
+        }
+    }
+
+    return Largest;
+}
+
+// The std::filesystem based normalizer VirtualFileSystem::GetPathWithoutExtension replaced, the keys it produces
+// have to stay the same since mount snapshots store them. Backslashes are turned into slashes up front so it splits
+// paths the same way on every platform, std::filesystem only treats them as separators on Windows.
+static std::string GetPathWithoutExtensionReference(std::string Path) {
+    std::replace(Path.begin(), Path.end(), '\\', '/');
+
+    std::filesystem::path FsPath(Path);
+    std::string NormalizedPath = FsPath.parent_path().string() + "/" + FsPath.stem().string();
+
+    if (!NormalizedPath.empty() && NormalizedPath[0] == '/') {
+        NormalizedPath = NormalizedPath.substr(1);
+    }
+
+    std::vector<std::string> Components;
+    std::istringstream Stream(NormalizedPath);
+    std::string Segment;
+    while (std::getline(Stream, Segment, '/')) {
+        if (Segment == "..") {
+            if (!Components.empty()) {
+                Components.pop_back();
+            }
+        }
+        else if (!Segment.empty() && Segment != ".") {
+            Components.push_back(Segment);
+        }
+    }
+
+    std::string Result;
+    for (const std::string& Component : Components) {
+        if (!Result.empty()) {
+            Result += "/";
+        }
+        Result += Component;
+    }
+
+    std::string LastPart = Result.substr(Result.find_last_of("/") + 1);
+    if (LastPart.find('.') != std::string::npos && LastPart.substr(0, LastPart.find('.')) == LastPart.substr(LastPart.find('.') + 1)) {
+        Result = Result.substr(0, Result.find_last_of("/")) + "/" + LastPart.substr(0, LastPart.find('.'));
+    }
+
+    std::transform(Result.begin(), Result.end(), Result.begin(), ::tolower);
+
+    const std::string GameName = "fortnitegame";
+    std::string Root = Result.substr(0, Result.find('/'));
+    std::string Tree = Result.substr(Result.find('/') + 1);
+
+    if (Root == "game" || Root == "engine") {
+        std::string RootName = (Root == "engine") ? "engine" : GameName;
+        std::string Root2 = Tree.substr(0, Tree.find('/'));
+        if (Root2 == "config" || Root2 == "content" || Root2 == "plugins") {
+            Result = RootName + "/" + Tree;
+        }
+        else {
+            Result = RootName + "/content/" + Tree;
+        }
+    }
+    else if (Root != GameName) {
+        Result = GameName + "/plugins/gamefeatures/" + Root + "/content/" + Tree;
+    }
+
+    return Result;
+}
+
+static void RunContainerBenchmarks(FBenchmarkRunner& Runner, const FBenchmarkOptions& Options, TMap<FGuid, FAESKey>& Keys) {
+    std::string TocPath = FindLargestContainer(Options.PakDirectory);
+    if (TocPath.empty()) {
+        LOG_ERROR("No containers found in {0}", Options.PakDirectory);
+        return;
+    }
+
+    std::string ContainerPath = std::filesystem::path(TocPath).replace_extension("").string();
+    uint64_t TocSize = std::filesystem::file_size(TocPath);
+    LOG_INFO("Using container {0}", ContainerPath);
+
+    FIoStoreTocResource ParsedToc;
+    Runner.Run({
+        .Name = "TocParse",
+        .Bytes = TocSize,
+        .Setup = [&]() { ParsedToc = FIoStoreTocResource(); },
+        .Body = [&]() { return FIoStoreTocResource::Read(TocPath, EIoStoreTocReadOptions::ReadAll, ParsedToc).IsOk(); }
+    });
+
+    FIoStoreReader Reader;
+    FIoStatus Status = Reader.Initialize(ContainerPath, Keys);
+    if (!Status.IsOk()) {
+        LOG_ERROR("Failed to mount {0}: {1}", ContainerPath, Status.ToString());
+        return;
+    }
+
+    std::vector<std::pair<std::string, uint32_t>> Files;
+    Reader.GetFiles(Files);
+
+    Runner.Run({
+        .Name = "DirectoryIndexIteration",
+        .Items = Files.size(),
+        .Setup = [&]() { Files.clear(); },
+        .Body = [&]() { Reader.GetFiles(Files); return !Files.empty(); }
+    });
+
+    // Single lookups the way a tool that only needs a few files would do them, without registering anything
+    std::vector<std::string> LookupPaths;
+    for (size_t i = 0; i < Files.size() && LookupPaths.size() < Options.ChunkSampleCount; i += std::max<size_t>(Files.size() / std::max(Options.ChunkSampleCount, 1u), 1)) {
+        LookupPaths.push_back(Files[i].first);
+    }
+
+    Runner.Run({
+        .Name = "DirectoryIndexLookup",
+        .Items = LookupPaths.size(),
+        .Body = [&]() {
+            for (const std::string& Path : LookupPaths) {
+                if (!Reader.FindTocEntryIndex(Path)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    });
+
+    // Mount snapshots store path hashes, so the single pass normalizer has to give the same keys as the old one
+    size_t NormalizeMismatches = 0;
+    for (const auto& [Path, TocEntryIndex] : Files) {
+        std::string Expected = GetPathWithoutExtensionReference(Path);
+        std::string Actual = VirtualFileSystem::GetPathWithoutExtension(Path);
+        if (Actual != Expected || VirtualFileSystem::HashPathWithoutExtension(Path) != XXH3_64bits(Expected.data(), Expected.size())) {
+            if (NormalizeMismatches++ < 10) {
+                LOG_ERROR("Path {0} normalizes to {1}, reference gives {2}", Path, Actual, Expected);
+            }
+        }
+    }
+    if (NormalizeMismatches) {
+        LOG_ERROR("{0} of {1} paths don't match the reference normalizer", NormalizeMismatches, Files.size());
+    }
+
+    Runner.Run({
+        .Name = "PathHash",
+        .Items = Files.size(),
+        .Body = [&]() {
+            uint64_t Hash = 0;
+            for (const auto& [Path, TocEntryIndex] : Files) {
+                Hash += VirtualFileSystem::HashPathWithoutExtension(Path);
+            }
+            return Hash != 0 || Files.empty();
+        }
+    });
+
+    Runner.Run({
+        .Name = "PathHashReference",
+        .Items = Files.size(),
+        .Body = [&]() {
+            uint64_t Hash = 0;
+            for (const auto& [Path, TocEntryIndex] : Files) {
+                std::string Normalized = GetPathWithoutExtensionReference(Path);
+                Hash += XXH3_64bits(Normalized.data(), Normalized.size());
+            }
+            return Hash != 0 || Files.empty();
+        }
+    });
+
+    std::unique_ptr<VirtualFileSystem> VFS;
+    Runner.Run({
+        .Name = "VfsRegistration",
+        .Items = Files.size(),
+        .Setup = [&]() { VFS = std::make_unique<VirtualFileSystem>(); },
+        .Body = [&]() { VFS->RegisterParallel(Files, VFS->RegisterReader(&Reader)); return true; }
+    });
+    if (VFS) {
+        FVfsMemoryStats VfsMemory = VFS->GetMemoryStats();
+        LOG_INFO("VFS holds {0} files in {1} bytes, {2:.1f} bytes per file", VfsMemory.Files, VfsMemory.GetTotalBytes(), VfsMemory.GetBytesPerFile());
+    }
+    VFS.reset();
+
+    // Evenly spaced sample so the reads touch the whole container
+    const FIoStoreTocResource& TocResource = Reader.GetTocResource();
+    std::vector<uint32_t> SampleIndices;
+    uint64_t SampleBytes = 0;
+    size_t Step = std::max<size_t>(Files.size() / std::max(Options.ChunkSampleCount, 1u), 1);
+    for (size_t i = 0; i < Files.size() && SampleIndices.size() < Options.ChunkSampleCount; i += Step) {
+        SampleIndices.push_back(Files[i].second);
+        SampleBytes += TocResource.ChunkOffsetAndLengths[Files[i].second].GetLength();
+    }
+
+    auto ReadSample = [&]() {
+        for (uint32_t TocEntryIndex : SampleIndices) {
+            FIoReadOptions ReadOptions(0, TocResource.ChunkOffsetAndLengths[TocEntryIndex].GetLength());
+            if (!Reader.Read(TocResource.ChunkIds[TocEntryIndex], ReadOptions).IsOk()) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    Runner.Run({
+        .Name = "ChunkReadCold",
+        .Bytes = SampleBytes,
+        .Items = SampleIndices.size(),
+        .Setup = []() { FIoBlockCache::Get().Clear(); },
+        .Body = ReadSample
+    });
+
+    Runner.Run({
+        .Name = "ChunkReadWarm",
+        .Bytes = SampleBytes,
+        .Items = SampleIndices.size(),
+        .Body = ReadSample
+    });
+
+    std::vector<FIoChunkId> SampleChunkIds;
+    for (uint32_t TocEntryIndex : SampleIndices) {
+        SampleChunkIds.push_back(TocResource.ChunkIds[TocEntryIndex]);
+    }
+
+    Runner.Run({
+        .Name = "ChunkReadBatchCold",
+        .Bytes = SampleBytes,
+        .Items = SampleIndices.size(),
+        .Setup = []() { FIoBlockCache::Get().Clear(); },
+        .Body = [&]() {
+            for (const TIoStatusOr<FIoBuffer>& Result : Reader.ReadBatch(SampleChunkIds)) {
+                if (!Result.IsOk()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    });
+
+    // Header-sized peek at every sample chunk, only the first block of each should get decoded
+    Runner.Run({
+        .Name = "ChunkArchiveHeaderCold",
+        .Items = SampleIndices.size(),
+        .Setup = []() { FIoBlockCache::Get().Clear(); },
+        .Body = [&]() {
+            uint8_t Header[256];
+            for (uint32_t TocEntryIndex : SampleIndices) {
+                FIoChunkArchive Ar(Reader, TocResource.ChunkIds[TocEntryIndex]);
+                const int64_t HeaderSize = std::min<int64_t>(sizeof(Header), Ar.TotalSize());
+                if (!Ar.IsValid() || !Ar.Serialize(Header, HeaderSize)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    });
+
+    // Same reads decoded into one reused buffer, the way pooled callers would do them
+    std::vector<uint8_t> ReadIntoBuffer;
+    Runner.Run({
+        .Name = "ChunkReadIntoWarm",
+        .Bytes = SampleBytes,
+        .Items = SampleIndices.size(),
+        .Body = [&]() {
+            for (uint32_t TocEntryIndex : SampleIndices) {
+                const uint64_t ChunkSize = TocResource.ChunkOffsetAndLengths[TocEntryIndex].GetLength();
+                if (ReadIntoBuffer.size() < ChunkSize) {
+                    ReadIntoBuffer.resize(ChunkSize);
+                }
+                if (!Reader.Read(TocResource.ChunkIds[TocEntryIndex], FIoReadOptions(0, ChunkSize), ReadIntoBuffer).IsOk()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    });
+
+    // Hashes an evenly spread tenth of the container on every worker, straight from disk
+    FIoVerifyOptions VerifyOptions { .SampleRate = 0.1 };
+    TIoStatusOr<FIoVerifyResult> VerifySample = Reader.Verify(VerifyOptions);
+    if (!VerifySample.IsOk()) {
+        LOG_WARN("Skipping ChunkVerifySampled: {0}", VerifySample.Status().ToString());
+        return;
+    }
+    if (!VerifySample.ValueOrDie().IsOk()) {
+        LOG_WARN("{0} sampled chunks don't match their TOC hash", VerifySample.ValueOrDie().Mismatches.size());
+    }
+
+    Runner.Run({
+        .Name = "ChunkVerifySampled",
+        .Bytes = VerifySample.ValueOrDie().VerifiedBytes,
+        .Items = VerifySample.ValueOrDie().VerifiedChunks,
+        .Body = [&]() { return Reader.Verify(VerifyOptions).IsOk(); }
+    });
+}
+
+static void RunAesBenchmarks(FBenchmarkRunner& Runner, const FBenchmarkOptions& Options) {
+    // Decrypting garbage is as fast as decrypting real data, so any key will do
+    FAESKey Key(Options.AESKey);
+    std::vector<uint8_t> Data(16 * 1024 * 1024, 0xA5);
+
+    Runner.Run({
+        .Name = std::string("AesDecrypt[") + FAESKey::GetDecryptorName() + "]",
+        .Bytes = Data.size(),
+        .Body = [&]() { Key.DecryptData(Data.data(), Data.size()); return true; }
+    });
+
+    Runner.Run({
+        .Name = "AesDecryptReference",
+        .Bytes = Data.size(),
+        .Body = [&]() { Key.DecryptDataReference(Data.data(), Data.size()); return true; }
+    });
+}
+
+static void RunPackageBenchmarks(FBenchmarkRunner& Runner, const FBenchmarkOptions& Options, FFileProvider& Provider) {
+    if (Options.PackagePath.empty()) {
+        LOG_WARN("No --package given, skipping package benchmarks");
+        return;
+    }
+
+    FIoStoreReader* Reader = Provider.GetReaderByPathAndExtension(Options.PackagePath);
+    if (!Reader) {
+        LOG_ERROR("Package {0} is not mounted", Options.PackagePath);
+        return;
+    }
+
+    const FIoStoreTocResource& TocResource = Reader->GetTocResource();
+    uint32_t TocEntryIndex = Provider.GetTocEntryIndexByPathAndExtension(Options.PackagePath);
+    uint64_t PackageSize = TocResource.ChunkOffsetAndLengths[TocEntryIndex].GetLength();
+
+    TIoStatusOr<FIoBuffer> Entry = Reader->Read(TocResource.ChunkIds[TocEntryIndex], FIoReadOptions(0, PackageSize));
+    if (!Entry.IsOk()) {
+        LOG_ERROR("Failed to read {0}: {1}", Options.PackagePath, Entry.Status().ToString());
+        return;
+    }
+
+    FIoBuffer Buffer = Entry.ConsumeValueOrDie();
+    FZenPackageReader PackageReader(Buffer);
+    if (!PackageReader.IsOk()) {
+        LOG_ERROR("Failed to parse {0}: {1}", Options.PackagePath, PackageReader.GetStatus().ToString());
+        return;
+    }
+
+    FZenPackageSummary* Summary = PackageReader.GetPackageSummary();
+    Runner.Run({
+        .Name = "NameBatchLoad",
+        .Bytes = Summary->HeaderSize - sizeof(FZenPackageSummary),
+        .Items = static_cast<uint64_t>(PackageReader.GetNameMap().Num()),
+        .Body = [&]() {
+            FMemoryReader Ar(Buffer.GetData() + sizeof(FZenPackageSummary), Summary->HeaderSize - sizeof(FZenPackageSummary));
+            return !FNameMap::LoadNameBatch(Ar).empty();
+        }
+    });
+
+    // Exports are serialized back to back in export bundle order, each starting with its unversioned header
+    std::vector<uint64_t> ExportOffsets;
+    uint64_t ExportOffset = Summary->HeaderSize;
+    for (const FExportBundleEntry& BundleEntry : PackageReader.GetExportBundleEntries()) {
+        if (BundleEntry.CommandType != FExportBundleEntry::ExportCommandType_Serialize) continue;
+
+        ExportOffsets.push_back(ExportOffset);
+        ExportOffset += PackageReader.GetExportMap()[BundleEntry.LocalExportIndex].CookedSerialSize;
+    }
+
+    Runner.Run({
+        .Name = "UnversionedHeaderParse",
+        .Items = ExportOffsets.size(),
+        .Body = [&]() {
+            for (uint64_t Offset : ExportOffsets) {
+                PackageReader.Seek(Offset);
+
+                FUnversionedHeader Header;
+                if (!Header.Load(PackageReader).IsOk()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    });
+
+    Runner.Run({
+        .Name = "LoadPackageWarm",
+        .Bytes = PackageSize,
+        .Setup = [&]() { Provider.GetPackageCache().Clear(); },
+        .Body = [&]() { return Provider.LoadPackage(Options.PackagePath) != nullptr; }
+    });
+
+    Runner.Run({
+        .Name = "LoadPackageCold",
+        .Bytes = PackageSize,
+        .Setup = [&]() { Provider.GetPackageCache().Clear(); FIoBlockCache::Get().Clear(); },
+        .Body = [&]() { return Provider.LoadPackage(Options.PackagePath) != nullptr; }
+    });
+}
+
+int main(int argc, char* argv[]) {
+    Log::Init();
+
+    FBenchmarkOptions Options;
+    if (!ParseOptions(argc, argv, Options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    Oodle::LoadDLL(Options.OodleDll.c_str());
+    FAsyncReadBackend::Configure(Options.ReadBackend);
+
+    FGuid MainGuid;
+    FAESKey MainKey(Options.AESKey);
+    TMap<FGuid, FAESKey> Keys;
+    if (!Options.AESKey.empty()) {
+        Keys.insert({ MainGuid, MainKey });
+    }
+
+    FBenchmarkRunner Runner(Options.Iterations, Options.WarmupIterations, Options.Filter);
+
+    RunContainerBenchmarks(Runner, Options, Keys);
+    RunAesBenchmarks(Runner, Options);
+
+    FFileProvider Provider(Options.PakDirectory, Options.MappingsFile);
+    Provider.SubmitKeys(Keys);
+
+    // Mounting is measured as a whole, the last iteration leaves the provider mounted for the package benchmarks
+    Runner.Run({
+        .Name = "Mount",
+        .Setup = [&]() { Provider.Unmount(); },
+        .Body = [&]() { Provider.MountAsync(); return !Provider.GetArchives().empty(); }
+    });
+    if (Runner.IsFiltered("Mount")) {
+        Provider.MountAsync();
+    }
+
+    // The first mount with a snapshot path writes the snapshot, every timed one after it reads it
+    if (!Options.SnapshotPath.empty() && !Runner.IsFiltered("MountFromSnapshot")) {
+        Provider.SetMountSnapshotPath(Options.SnapshotPath);
+        Provider.Unmount();
+        Provider.MountAsync();
+
+        Runner.Run({
+            .Name = "MountFromSnapshot",
+            .Setup = [&]() { Provider.Unmount(); },
+            .Body = [&]() { Provider.MountAsync(); return !Provider.GetArchives().empty(); }
+        });
+    }
+
+    RunPackageBenchmarks(Runner, Options, Provider);
+
+    Runner.PrintResults();
+    if (!Options.CsvPath.empty()) {
+        Runner.WriteCsv(Options.CsvPath);
+    }
+
+    return 0;
+}
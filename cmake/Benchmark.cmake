@@ -0,0 +1,33 @@
+# Benchmark executable for the asset pipeline (IoStore, VFS, Zen packages, reflection) without the UI.
+# It is not part of the default build: cmake --build <dir> --target SaturnBenchmark
+MACRO(ADD_BENCHMARK)
+  set(BENCHMARK_NAME ${CMAKE_PROJECT_NAME}Benchmark)
+
+  file(GLOB_RECURSE benchmark_SRC "src/Unreal/*.h"
+                                  "src/Unreal/*.hpp"
+                                  "src/Unreal/*.cpp"
+                                  "src/Unreal/*.ixx"
+                                  "src/Readers/*.h"
+                                  "src/Readers/*.cpp"
+                                  "src/Readers/*.ixx"
+                                  "src/Reflection/*.h"
+                                  "src/Reflection/*.cpp"
+                                  "src/Reflection/*.ixx"
+                                  "lib/blake3/*.c"
+                                  "benchmarks/*.cpp"
+                                  "benchmarks/*.ixx")
+
+  # Legacy pak support depends on the app state
+  list(FILTER benchmark_SRC EXCLUDE REGEX "src/Unreal/Structs/Pak/")
+
+  list(APPEND benchmark_SRC "src/Saturn/Defines.h"
+                            "src/Saturn/Log.h"
+                            "src/Saturn/Log.cpp"
+                            "src/Saturn/Core/GlobalContext.ixx"
+                            "lib/xxhash/xxhash.cpp")
+
+  add_executable(${BENCHMARK_NAME} EXCLUDE_FROM_ALL ${benchmark_SRC})
+
+  # The app adds the UI libraries to the whole directory, the benchmark doesn't need any of them
+  set_property(TARGET ${BENCHMARK_NAME} PROPERTY LINK_LIBRARIES "")
+ENDMACRO()
@@ -0,0 +1,330 @@
+#include "Saturn/Log.h"
+
+import Saturn.Readers.AsyncReadBackend;
+
+import <mutex>;
+import <deque>;
+import <atomic>;
+import <memory>;
+import <thread>;
+import <cstring>;
+import <cstdint>;
+import <exception>;
+import <functional>;
+import <condition_variable>;
+
+import Saturn.Core.TaskExecutor;
+import Saturn.Readers.PositionalFileReader;
+import Saturn.Readers.ContainerFileMapping;
+
+#if defined(__linux__)
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
+
+// Callbacks run on the ring thread or inline in Read, an escaping exception would terminate the process or skip
+// the rest of the completions. The caller's own cleanup is what fails the read.
+static void RunCallback(const FAsyncReadBackend::FReadCallback& Callback, bool bSucceeded) {
+    try {
+        Callback(bSucceeded);
+    }
+    catch (const std::exception& Exception) {
+        LOG_ERROR("Unhandled exception in async read callback: {0}", Exception.what());
+    }
+    catch (...) {
+        LOG_ERROR("Unhandled exception in async read callback");
+    }
+}
+
+// Every read is a blocking read on an executor worker, preferring the shared mapping when it covers the range
+class FThreadPoolReadBackend final : public FAsyncReadBackend {
+public:
+    void Read(const FAsyncReadRequest& Request, FReadCallback&& Callback) override {
+        FTaskExecutor::Get().Enqueue([Request, Callback = std::move(Callback)]() {
+            const bool bSucceeded = (Request.Mapping && Request.Mapping->ReadAt(Request.Destination, Request.Length, Request.Offset))
+                || Request.File->ReadAt(Request.Destination, Request.Length, Request.Offset);
+            RunCallback(Callback, bSucceeded);
+        });
+    }
+
+    const char* GetName() const override { return "ThreadPool"; }
+};
+
+#if defined(__linux__)
+// Keeps up to QueueDepth reads in flight from a single thread instead of one blocked worker per read. Producers
+// only append to a queue, the ring thread moves everything queued into the submission ring and hands it to the
+// kernel in one io_uring_enter, then reaps completions in the same call. Talks to the kernel through the raw
+// syscalls so there's no liburing dependency.
+//
+// Reads go through the file descriptor even when a mapping covers them. Faulting pages in through a mapping is
+// synchronous, only reads submitted to the ring get the queue depth.
+class FIoUringReadBackend final : public FAsyncReadBackend {
+public:
+    static std::unique_ptr<FIoUringReadBackend> Create(uint32_t QueueDepth) {
+        std::unique_ptr<FIoUringReadBackend> Backend(new FIoUringReadBackend());
+        if (!Backend->SetupRing(QueueDepth)) {
+            return nullptr;
+        }
+
+        Backend->RingThread = std::thread([Backend = Backend.get()]() { Backend->RingMain(); });
+        return Backend;
+    }
+
+    ~FIoUringReadBackend() override {
+        if (RingThread.joinable()) {
+            {
+                std::lock_guard<std::mutex> Lock(Mutex);
+                bStop = true;
+            }
+            Condition.notify_one();
+            RingThread.join();
+        }
+
+        if (Sqes) munmap(Sqes, SqesSize);
+        if (CqRing && CqRing != SqRing) munmap(CqRing, CqRingSize);
+        if (SqRing) munmap(SqRing, SqRingSize);
+        if (RingFd != -1) close(RingFd);
+    }
+
+    void Read(const FAsyncReadRequest& Request, FReadCallback&& Callback) override {
+        std::unique_ptr<FPendingRead> PendingRead = std::make_unique<FPendingRead>();
+        PendingRead->Fd = Request.File->GetFileDescriptor();
+        PendingRead->Destination = static_cast<uint8_t*>(Request.Destination);
+        PendingRead->Remaining = Request.Length;
+        PendingRead->Offset = Request.Offset;
+        PendingRead->Callback = std::move(Callback);
+
+        if (PendingRead->Fd == -1 || Request.Length < 0 || Request.Offset < 0) {
+            RunCallback(PendingRead->Callback, false);
+            return;
+        }
+        if (Request.Length == 0) {
+            RunCallback(PendingRead->Callback, true);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Pending.push_back(std::move(PendingRead));
+        }
+        Condition.notify_one();
+    }
+
+    const char* GetName() const override { return "io_uring"; }
+private:
+    struct FPendingRead {
+        int Fd = -1;
+        uint8_t* Destination = nullptr;
+        int64_t Remaining = 0;
+        int64_t Offset = 0;
+        iovec Vector = {};
+        FReadCallback Callback;
+    };
+
+    FIoUringReadBackend() = default;
+
+    bool SetupRing(uint32_t QueueDepth) {
+        io_uring_params Params = {};
+        RingFd = static_cast<int>(syscall(__NR_io_uring_setup, QueueDepth, &Params));
+        if (RingFd < 0) {
+            RingFd = -1;
+            return false;
+        }
+
+        SqRingSize = Params.sq_off.array + Params.sq_entries * sizeof(uint32_t);
+        CqRingSize = Params.cq_off.cqes + Params.cq_entries * sizeof(io_uring_cqe);
+        if (Params.features & IORING_FEAT_SINGLE_MMAP) {
+            SqRingSize = CqRingSize = SqRingSize > CqRingSize ? SqRingSize : CqRingSize;
+        }
+
+        SqRing = static_cast<uint8_t*>(mmap(nullptr, SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_SQ_RING));
+        if (SqRing == MAP_FAILED) {
+            SqRing = nullptr;
+            return false;
+        }
+
+        if (Params.features & IORING_FEAT_SINGLE_MMAP) {
+            CqRing = SqRing;
+        }
+        else {
+            CqRing = static_cast<uint8_t*>(mmap(nullptr, CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_CQ_RING));
+            if (CqRing == MAP_FAILED) {
+                CqRing = nullptr;
+                return false;
+            }
+        }
+
+        SqesSize = Params.sq_entries * sizeof(io_uring_sqe);
+        Sqes = static_cast<io_uring_sqe*>(mmap(nullptr, SqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFd, IORING_OFF_SQES));
+        if (Sqes == MAP_FAILED) {
+            Sqes = nullptr;
+            return false;
+        }
+
+        SqTail = reinterpret_cast<uint32_t*>(SqRing + Params.sq_off.tail);
+        SqMask = *reinterpret_cast<uint32_t*>(SqRing + Params.sq_off.ring_mask);
+        SqArray = reinterpret_cast<uint32_t*>(SqRing + Params.sq_off.array);
+        CqHead = reinterpret_cast<uint32_t*>(CqRing + Params.cq_off.head);
+        CqTail = reinterpret_cast<uint32_t*>(CqRing + Params.cq_off.tail);
+        CqMask = *reinterpret_cast<uint32_t*>(CqRing + Params.cq_off.ring_mask);
+        Cqes = reinterpret_cast<io_uring_cqe*>(CqRing + Params.cq_off.cqes);
+        Capacity = Params.sq_entries;
+        return true;
+    }
+
+    // Caller owns the submission tail, only the ring thread writes it
+    void PrepareRead(FPendingRead* PendingRead) {
+        PendingRead->Vector.iov_base = PendingRead->Destination;
+        PendingRead->Vector.iov_len = static_cast<size_t>(PendingRead->Remaining < (1 << 30) ? PendingRead->Remaining : (1 << 30));
+
+        const uint32_t Tail = *SqTail;
+        const uint32_t Index = Tail & SqMask;
+
+        // READV rather than READ so kernels before 5.6 work too
+        io_uring_sqe& Sqe = Sqes[Index];
+        memset(&Sqe, 0, sizeof(io_uring_sqe));
+        Sqe.opcode = IORING_OP_READV;
+        Sqe.fd = PendingRead->Fd;
+        Sqe.addr = reinterpret_cast<uint64_t>(&PendingRead->Vector);
+        Sqe.len = 1;
+        Sqe.off = static_cast<uint64_t>(PendingRead->Offset);
+        Sqe.user_data = reinterpret_cast<uint64_t>(PendingRead);
+
+        SqArray[Index] = Index;
+        std::atomic_ref<uint32_t>(*SqTail).store(Tail + 1, std::memory_order_release);
+    }
+
+    void RingMain() {
+        uint32_t InFlight = 0;  // Consumed by the kernel, not completed yet
+        uint32_t Queued = 0;    // In the submission ring, not consumed yet
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> Lock(Mutex);
+                if (InFlight + Queued == 0) {
+                    Condition.wait(Lock, [this]() { return bStop || !Pending.empty(); });
+                    if (Pending.empty()) {
+                        return;
+                    }
+                }
+
+                while (!Pending.empty() && InFlight + Queued < Capacity) {
+                    PrepareRead(Pending.front().release());
+                    Pending.pop_front();
+                    Queued++;
+                }
+            }
+
+            // Submits everything queued and waits for at least one completion in the same call
+            const int Consumed = static_cast<int>(syscall(__NR_io_uring_enter, RingFd, Queued, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (Consumed < 0) {
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                    LOG_ERROR("io_uring_enter failed with errno {0}", errno);
+                    std::this_thread::yield();
+                }
+            }
+            else {
+                Queued -= static_cast<uint32_t>(Consumed);
+                InFlight += static_cast<uint32_t>(Consumed);
+            }
+
+            InFlight -= ReapCompletions();
+        }
+    }
+
+    uint32_t ReapCompletions() {
+        uint32_t Head = *CqHead;
+        const uint32_t Tail = std::atomic_ref<uint32_t>(*CqTail).load(std::memory_order_acquire);
+        uint32_t Completed = 0;
+
+        for (; Head != Tail; ++Head, ++Completed) {
+            const io_uring_cqe& Cqe = Cqes[Head & CqMask];
+            FPendingRead* PendingRead = reinterpret_cast<FPendingRead*>(Cqe.user_data);
+            const int32_t Result = Cqe.res;
+
+            // Short reads and interrupted reads go back in the queue for the rest
+            if (Result == -EINTR || Result == -EAGAIN || (Result > 0 && Result < PendingRead->Remaining)) {
+                if (Result > 0) {
+                    PendingRead->Destination += Result;
+                    PendingRead->Offset += Result;
+                    PendingRead->Remaining -= Result;
+                }
+
+                std::lock_guard<std::mutex> Lock(Mutex);
+                Pending.emplace_front(PendingRead);
+                continue;
+            }
+
+            std::unique_ptr<FPendingRead> FinishedRead(PendingRead);
+            RunCallback(FinishedRead->Callback, Result == FinishedRead->Remaining);
+        }
+
+        std::atomic_ref<uint32_t>(*CqHead).store(Head, std::memory_order_release);
+        return Completed;
+    }
+
+    int RingFd = -1;
+    uint32_t Capacity = 0;
+
+    uint8_t* SqRing = nullptr;
+    size_t SqRingSize = 0;
+    uint32_t* SqTail = nullptr;
+    uint32_t SqMask = 0;
+    uint32_t* SqArray = nullptr;
+    io_uring_sqe* Sqes = nullptr;
+    size_t SqesSize = 0;
+
+    uint8_t* CqRing = nullptr;
+    size_t CqRingSize = 0;
+    uint32_t* CqHead = nullptr;
+    uint32_t* CqTail = nullptr;
+    uint32_t CqMask = 0;
+    io_uring_cqe* Cqes = nullptr;
+
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    std::deque<std::unique_ptr<FPendingRead>> Pending;
+    bool bStop = false;
+    std::thread RingThread;
+};
+#endif
+
+static std::mutex BackendMutex;
+static FAsyncReadBackendSettings Settings;
+static std::unique_ptr<FAsyncReadBackend> Backend;
+
+void FAsyncReadBackend::Configure(const FAsyncReadBackendSettings& InSettings) {
+    std::lock_guard<std::mutex> Lock(BackendMutex);
+    if (Backend) {
+        LOG_WARN("Async read backend '{0}' is already in use, new settings are ignored", Backend->GetName());
+        return;
+    }
+    Settings = InSettings;
+}
+
+FAsyncReadBackend& FAsyncReadBackend::Get() {
+    static FAsyncReadBackend& Instance = []() -> FAsyncReadBackend& {
+        std::lock_guard<std::mutex> Lock(BackendMutex);
+
+#if defined(__linux__)
+        if (Settings.Backend == EAsyncReadBackend::IoUring) {
+            Backend = FIoUringReadBackend::Create(Settings.QueueDepth ? Settings.QueueDepth : 1);
+            if (!Backend) {
+                LOG_WARN("io_uring is unavailable (errno {0}), using the thread pool for container reads", errno);
+            }
+        }
+#endif
+
+        if (!Backend) {
+            Backend = std::make_unique<FThreadPoolReadBackend>();
+        }
+
+        LOG_INFO("Using the {0} backend for async container reads", Backend->GetName());
+        return *Backend;
+    }();
+    return Instance;
+}
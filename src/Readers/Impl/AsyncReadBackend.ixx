@@ -0,0 +1,49 @@
+export module Saturn.Readers.AsyncReadBackend;
+
+import <cstdint>;
+import <functional>;
+
+import Saturn.Readers.PositionalFileReader;
+import Saturn.Readers.ContainerFileMapping;
+
+export enum class EAsyncReadBackend : uint8_t {
+    ThreadPool, // Blocking reads on the task executor, works everywhere
+    IoUring     // Linux only, falls back to ThreadPool if the kernel doesn't allow it
+};
+
+export struct FAsyncReadBackendSettings {
+#if defined(__linux__)
+    EAsyncReadBackend Backend = EAsyncReadBackend::IoUring;
+#else
+    EAsyncReadBackend Backend = EAsyncReadBackend::ThreadPool;
+#endif
+    uint32_t QueueDepth = 128; // Reads the io_uring backend keeps in flight at once
+};
+
+// One container range to read. Both sources stay owned by the caller until the callback has run.
+export struct FAsyncReadRequest {
+    const FPositionalFileReader* File = nullptr;
+    const FContainerFileMapping* Mapping = nullptr; // Used by backends that read through memory when it covers the range
+    void* Destination = nullptr;
+    int64_t Length = 0;
+    int64_t Offset = 0;
+};
+
+// Where container reads that don't need to block the calling thread are sent. One process-wide backend is
+// picked on first use, so Configure has to be called before any container is read from.
+export class FAsyncReadBackend {
+public:
+    using FReadCallback = std::function<void(bool bSucceeded)>;
+
+    virtual ~FAsyncReadBackend() = default;
+
+    // Queues a read of exactly Request.Length bytes. The callback may run on any thread and should stay short,
+    // e.g. hand the decode off to the task executor. Exceptions thrown by the callback are logged and swallowed.
+    // Read only throws before it took the callback, in that case the callback never runs.
+    virtual void Read(const FAsyncReadRequest& Request, FReadCallback&& Callback) = 0;
+
+    virtual const char* GetName() const = 0;
+
+    static void Configure(const FAsyncReadBackendSettings& InSettings);
+    static FAsyncReadBackend& Get();
+};
@@ -0,0 +1,305 @@
+#include "Saturn/Defines.h"
+#include "Saturn/Log.h"
+
+import Saturn.Readers.ContainerFileMapping;
+
+import <mutex>;
+import <atomic>;
+import <memory>;
+import <string>;
+import <future>;
+import <cstring>;
+import <algorithm>;
+import <cstdint>;
+import <filesystem>;
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <Windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <signal.h>
+    #include <setjmp.h>
+#endif
+
+std::mutex FContainerFileMapping::RegistryMutex;
+TMap<std::string, std::weak_ptr<FContainerFileMapping>> FContainerFileMapping::Registry;
+
+struct FContainerFileMapping::FView {
+    void* Data = nullptr;
+    int64_t Size = 0;
+    // How far reads may go, drops below Size once a read found the file truncated under the mapping
+    std::atomic<int64_t> BackedSize = 0;
+    // Set by ReleaseView, fulfilled once the last holder let go and the view is unmapped
+    std::promise<void>* Unmapped = nullptr;
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    HANDLE hMapping = NULL;
+#else
+    int fd = -1;
+#endif
+
+    ~FView() {
+#if defined(_WIN32) || defined(_WIN64)
+        if (Data) UnmapViewOfFile(Data);
+        if (hMapping) CloseHandle(hMapping);
+        if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+#else
+        if (Data) munmap(Data, Size);
+        if (fd != -1) close(fd);
+#endif
+        if (Unmapped) Unmapped->set_value();
+    }
+
+    // Called after a copy faulted, the file only backs the mapping up to its current size
+    void RefreshBackedSize() {
+#if !defined(_WIN32) && !defined(_WIN64)
+        struct stat sb;
+        BackedSize.store(fstat(fd, &sb) == 0 ? std::min<int64_t>(sb.st_size, Size) : 0);
+#endif
+    }
+};
+
+#if !defined(_WIN32) && !defined(_WIN64)
+// Touching a mapped page past the end of a file another process truncated raises SIGBUS. Copies out of the
+// mapping register a jump target, the handler returns to it so the read fails instead of the process dying.
+// Faults outside of a copy go to whatever handler was installed before.
+static thread_local sigjmp_buf* volatile t_CopyFaultTarget = nullptr;
+static struct sigaction s_PreviousBusAction;
+
+static void HandleBusError(int Signal, siginfo_t* Info, void* Context) {
+    if (sigjmp_buf* Target = t_CopyFaultTarget) {
+        t_CopyFaultTarget = nullptr;
+        siglongjmp(*Target, 1);
+    }
+
+    if (s_PreviousBusAction.sa_flags & SA_SIGINFO) {
+        s_PreviousBusAction.sa_sigaction(Signal, Info, Context);
+    }
+    else if (s_PreviousBusAction.sa_handler == SIG_DFL) {
+        sigaction(SIGBUS, &s_PreviousBusAction, nullptr);
+        raise(Signal);
+    }
+    else if (s_PreviousBusAction.sa_handler != SIG_IGN) {
+        s_PreviousBusAction.sa_handler(Signal);
+    }
+}
+
+static void InstallBusErrorHandler() {
+    static std::once_flag Installed;
+    std::call_once(Installed, []() {
+        struct sigaction Action = {};
+        Action.sa_sigaction = HandleBusError;
+        // NODEFER so SIGBUS isn't left blocked after jumping out of the handler, sigsetjmp doesn't restore the mask
+        Action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&Action.sa_mask);
+        sigaction(SIGBUS, &Action, &s_PreviousBusAction);
+    });
+}
+
+// memcpy that returns false instead of crashing when the source pages are gone
+static bool CopyFromMapping(void* Destination, const void* Source, size_t Length) {
+    sigjmp_buf Target;
+    if (sigsetjmp(Target, 0)) {
+        return false;
+    }
+
+    // The fences keep the compiler from moving the copy out from between the two stores
+    t_CopyFaultTarget = &Target;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    memcpy(Destination, Source, Length);
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    t_CopyFaultTarget = nullptr;
+    return true;
+}
+#endif
+
+// Readers and writers build container paths in different ways, the registry has to see them as one file
+static std::string GetRegistryKey(const std::string& Path) {
+    return std::filesystem::path(Path).lexically_normal().make_preferred().string();
+}
+
+std::shared_ptr<FContainerFileMapping::FView> FContainerFileMapping::MapView(const std::string& Path) {
+    std::shared_ptr<FView> NewView = std::make_shared<FView>();
+
+#if defined(_WIN32) || defined(_WIN64)
+    NewView->hFile = CreateFileA(Path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    LARGE_INTEGER FileSize;
+    if (NewView->hFile == INVALID_HANDLE_VALUE || !GetFileSizeEx(NewView->hFile, &FileSize) || FileSize.QuadPart == 0) {
+        return nullptr;
+    }
+
+    NewView->hMapping = CreateFileMappingA(NewView->hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (NewView->hMapping == NULL) {
+        return nullptr;
+    }
+
+    NewView->Data = MapViewOfFile(NewView->hMapping, FILE_MAP_READ, 0, 0, 0);
+    NewView->Size = FileSize.QuadPart;
+#else
+    int fd = open(Path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return nullptr;
+    }
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1 || sb.st_size == 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    InstallBusErrorHandler();
+
+    // The descriptor stays open so a faulting read can find out how far the file still goes
+    void* Data = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    NewView->fd = fd;
+    if (Data != MAP_FAILED) {
+        NewView->Data = Data;
+        NewView->Size = sb.st_size;
+    }
+#endif
+
+    NewView->BackedSize.store(NewView->Size);
+    return NewView->Data ? NewView : nullptr;
+}
+
+FContainerFileMapping::~FContainerFileMapping() {
+    std::lock_guard<std::mutex> Lock(RegistryMutex);
+    auto It = Registry.find(GetRegistryKey(FilePath));
+    if (It != Registry.end() && It->second.expired()) {
+        Registry.erase(It);
+    }
+}
+
+TSharedPtr<FContainerFileMapping> FContainerFileMapping::Get(const std::string& Path) {
+    const std::string Key = GetRegistryKey(Path);
+
+    std::lock_guard<std::mutex> Lock(RegistryMutex);
+    if (auto It = Registry.find(Key); It != Registry.end()) {
+        if (TSharedPtr<FContainerFileMapping> Existing = It->second.lock()) {
+            return Existing;
+        }
+    }
+
+    std::shared_ptr<FView> NewView = MapView(Path);
+    if (!NewView) {
+        LOG_WARN("Failed to map container file '{0}'", Path);
+        return nullptr;
+    }
+
+    TSharedPtr<FContainerFileMapping> Mapping(new FContainerFileMapping(Path));
+    Mapping->View.store(std::move(NewView));
+    Registry.insert_or_assign(Key, Mapping);
+    return Mapping;
+}
+
+void FContainerFileMapping::Release(const std::string& Path) {
+    TSharedPtr<FContainerFileMapping> Mapping;
+    {
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+        if (auto It = Registry.find(GetRegistryKey(Path)); It != Registry.end()) {
+            Mapping = It->second.lock();
+        }
+    }
+
+    if (Mapping) {
+        Mapping->ReleaseView();
+    }
+}
+
+void FContainerFileMapping::Remap(const std::string& Path) {
+    TSharedPtr<FContainerFileMapping> Mapping;
+    {
+        std::lock_guard<std::mutex> Lock(RegistryMutex);
+        if (auto It = Registry.find(GetRegistryKey(Path)); It != Registry.end()) {
+            Mapping = It->second.lock();
+        }
+    }
+
+    if (Mapping) {
+        Mapping->View.store(MapView(Mapping->FilePath));
+        Mapping->Advise(Mapping->AccessPattern.load());
+    }
+}
+
+void FContainerFileMapping::ReleaseView() {
+    // New reads can't pick the view up anymore, the ones that already hold it finish their copy first. Whoever
+    // drops the last reference unmaps the view and wakes us up.
+    std::shared_ptr<FView> OldView = View.exchange(nullptr);
+    if (!OldView) {
+        return;
+    }
+
+    std::promise<void> Unmapped;
+    std::future<void> UnmappedFuture = Unmapped.get_future();
+    OldView->Unmapped = &Unmapped;
+    OldView.reset();
+    UnmappedFuture.wait();
+}
+
+bool FContainerFileMapping::ReadAt(void* V, int64_t Length, int64_t Offset) const {
+    std::shared_ptr<FView> CurrentView = View.load(std::memory_order_acquire);
+    if (!CurrentView || Offset < 0 || Length < 0 || Offset + Length > CurrentView->BackedSize.load(std::memory_order_relaxed)) {
+        return false;
+    }
+
+#if defined(_WIN32) || defined(_WIN64)
+    // Windows refuses to truncate a file while a view of it is open
+    memcpy(V, static_cast<const uint8_t*>(CurrentView->Data) + Offset, Length);
+#else
+    // TrimToSize releases the view before truncating, only another process can shrink the file under a read
+    if (!CopyFromMapping(V, static_cast<const uint8_t*>(CurrentView->Data) + Offset, Length)) {
+        CurrentView->RefreshBackedSize();
+        return false;
+    }
+#endif
+    return true;
+}
+
+int64_t FContainerFileMapping::GetMappedSize() const {
+    std::shared_ptr<FView> CurrentView = View.load(std::memory_order_acquire);
+    return CurrentView ? CurrentView->Size : 0;
+}
+
+void FContainerFileMapping::Advise(EFileAccessPattern Pattern) const {
+    AccessPattern.store(Pattern);
+
+    std::shared_ptr<FView> CurrentView = View.load(std::memory_order_acquire);
+    if (!CurrentView) {
+        return;
+    }
+
+#if defined(_WIN32) || defined(_WIN64)
+    // Views have no access pattern hints on Windows, only explicit prefetching
+#else
+    int Advice = MADV_NORMAL;
+    if (Pattern == EFileAccessPattern::Sequential) Advice = MADV_SEQUENTIAL;
+    else if (Pattern == EFileAccessPattern::Random) Advice = MADV_RANDOM;
+    madvise(CurrentView->Data, CurrentView->Size, Advice);
+#endif
+}
+
+void FContainerFileMapping::Prefetch(int64_t Offset, int64_t Length) const {
+    std::shared_ptr<FView> CurrentView = View.load(std::memory_order_acquire);
+    if (!CurrentView || Offset < 0 || Length <= 0 || Offset >= CurrentView->Size) {
+        return;
+    }
+
+    if (Length > CurrentView->Size - Offset) {
+        Length = CurrentView->Size - Offset;
+    }
+
+#if defined(_WIN32) || defined(_WIN64)
+    WIN32_MEMORY_RANGE_ENTRY Range;
+    Range.VirtualAddress = static_cast<uint8_t*>(CurrentView->Data) + Offset;
+    Range.NumberOfBytes = static_cast<SIZE_T>(Length);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &Range, 0);
+#else
+    // madvise wants a page aligned start
+    const int64_t PageSize = sysconf(_SC_PAGESIZE);
+    const int64_t AlignedOffset = Offset & ~(PageSize - 1);
+    madvise(static_cast<uint8_t*>(CurrentView->Data) + AlignedOffset, Length + (Offset - AlignedOffset), MADV_WILLNEED);
+#endif
+}
@@ -0,0 +1,56 @@
+module;
+
+#include "Saturn/Defines.h"
+
+export module Saturn.Readers.ContainerFileMapping;
+
+import <mutex>;
+import <atomic>;
+import <memory>;
+import <string>;
+import <cstdint>;
+
+export enum class EFileAccessPattern : uint8_t {
+    Normal,
+    Sequential, // Bulk scans, read ahead aggressively
+    Random      // Package loads, don't read ahead
+};
+
+// Read-only mapping of a whole container file. There is one per file, shared by every reader of it, so
+// the file is only mapped once no matter how many readers or threads use it. The mapping covers the file
+// as it was when mapped; anything appended later has to be read some other way.
+export class FContainerFileMapping {
+public:
+    ~FContainerFileMapping();
+
+    // The live mapping of the file, mapping it if nobody has yet. nullptr if the file can't be mapped.
+    static TSharedPtr<FContainerFileMapping> Get(const std::string& Path);
+
+    // Unmaps the file for every holder and waits for reads in flight, so it can be truncated. Reads fail
+    // until Remap is called.
+    static void Release(const std::string& Path);
+    static void Remap(const std::string& Path);
+
+    // False if the range isn't mapped or the file no longer reaches that far, the caller is expected to fall back
+    // to a regular read. Truncation by another process is only noticed by the copy that faults on it.
+    bool ReadAt(void* V, int64_t Length, int64_t Offset) const;
+    int64_t GetMappedSize() const;
+
+    void Advise(EFileAccessPattern Pattern) const;
+
+    // Asks the OS to start reading the range in the background, returns immediately
+    void Prefetch(int64_t Offset, int64_t Length) const;
+private:
+    FContainerFileMapping(const std::string& InFilePath) : FilePath(InFilePath) {}
+
+    struct FView;
+    static std::shared_ptr<FView> MapView(const std::string& Path);
+    void ReleaseView();
+
+    std::string FilePath;
+    std::atomic<std::shared_ptr<FView>> View;
+    mutable std::atomic<EFileAccessPattern> AccessPattern{ EFileAccessPattern::Normal };
+
+    static std::mutex RegistryMutex;
+    static TMap<std::string, std::weak_ptr<FContainerFileMapping>> Registry;
+};
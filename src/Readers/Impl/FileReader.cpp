@@ -1,4 +1,5 @@
 import Saturn.Readers.FileReader;
+import Saturn.Readers.ContainerFileMapping;
 
 #include "Saturn/Log.h"
 #include <stdexcept>
@@ -134,10 +135,15 @@ bool FFileReader::TrimToSize(int64_t newSize, bool force) {
 
         Close(); // Close our own mapping
 
+        // Container readers share one read-only view per file, it has to go before the file can shrink
+        FContainerFileMapping::Release(FilePath);
+
 #if defined(_WIN32) || defined(_WIN64)
+        // Container readers keep plain read handles open without mapping the file, those don't stop
+        // SetEndOfFile so they're allowed to stay open. Only mapped views do, and those are closed above.
         HANDLE resizeHandle = CreateFileA(FilePath.c_str(),
             GENERIC_READ | GENERIC_WRITE,
-            0,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
             NULL,
             OPEN_EXISTING,
             FILE_ATTRIBUTE_NORMAL,
@@ -194,11 +200,13 @@ bool FFileReader::TrimToSize(int64_t newSize, bool force) {
         if (force) {
             notifyReadersToRemap(activeReaders);
         }
+        FContainerFileMapping::Remap(FilePath);
 
         LOG_INFO("Successfully trimmed file '{0}' to size {1}.", FilePath, newSize);
         return true;
     } catch (const std::exception& e) {
         LOG_ERROR("Failed to trim file '{0}': {1}", FilePath, e.what());
+        FContainerFileMapping::Remap(FilePath);
         try {
             openFileForMapping();
             if (force) {
@@ -0,0 +1,115 @@
+import Saturn.Readers.PositionalFileReader;
+
+#include "Saturn/Log.h"
+
+import <string>;
+import <cstdint>;
+import <algorithm>;
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #include <sys/stat.h>
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+// Reads on a synchronous handle are serialized by the I/O manager, so the handle is opened for overlapped
+// I/O and every thread waits on its own event instead
+struct FOverlappedEvent {
+    HANDLE Event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    ~FOverlappedEvent() { if (Event) CloseHandle(Event); }
+};
+static thread_local FOverlappedEvent ReadEvent;
+#endif
+
+FPositionalFileReader::FPositionalFileReader(const char* InFilename) : FilePath(InFilename) {
+#if defined(_WIN32) || defined(_WIN64)
+    hFile = CreateFileA(FilePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED | FILE_FLAG_RANDOM_ACCESS, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("Failed to open file '{0}'.", FilePath);
+    }
+#else
+    fd = open(FilePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        LOG_ERROR("Failed to open file '{0}'.", FilePath);
+    }
+#endif
+}
+
+FPositionalFileReader::~FPositionalFileReader() {
+    Close();
+}
+
+bool FPositionalFileReader::ReadAt(void* V, int64_t Length, int64_t Offset) const {
+    if (!IsValid() || Length < 0 || Offset < 0) {
+        return false;
+    }
+
+    uint8_t* Dest = static_cast<uint8_t*>(V);
+    while (Length > 0) {
+#if defined(_WIN32) || defined(_WIN64)
+        OVERLAPPED Overlapped = {};
+        Overlapped.Offset = static_cast<DWORD>(Offset);
+        Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+        Overlapped.hEvent = ReadEvent.Event;
+
+        const DWORD ToRead = static_cast<DWORD>(std::min<int64_t>(Length, 1 << 30));
+        DWORD BytesRead = 0;
+        if (!ReadFile(hFile, Dest, ToRead, NULL, &Overlapped) && GetLastError() != ERROR_IO_PENDING) {
+            return false;
+        }
+        if (!GetOverlappedResult(hFile, &Overlapped, &BytesRead, TRUE) || BytesRead == 0) {
+            return false;
+        }
+#else
+        const ssize_t BytesRead = pread(fd, Dest, static_cast<size_t>(std::min<int64_t>(Length, 1 << 30)), Offset);
+        if (BytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (BytesRead <= 0) {
+            return false;
+        }
+#endif
+        Dest += BytesRead;
+        Offset += BytesRead;
+        Length -= BytesRead;
+    }
+
+    return true;
+}
+
+int64_t FPositionalFileReader::TotalSize() const {
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER FileSize;
+    return IsValid() && GetFileSizeEx(hFile, &FileSize) ? FileSize.QuadPart : 0;
+#else
+    struct stat sb;
+    return IsValid() && fstat(fd, &sb) == 0 ? sb.st_size : 0;
+#endif
+}
+
+bool FPositionalFileReader::IsValid() const {
+#if defined(_WIN32) || defined(_WIN64)
+    return hFile != INVALID_HANDLE_VALUE;
+#else
+    return fd != -1;
+#endif
+}
+
+void FPositionalFileReader::Close() {
+#if defined(_WIN32) || defined(_WIN64)
+    if (hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(hFile);
+        hFile = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fd != -1) {
+        close(fd);
+        fd = -1;
+    }
+#endif
+}
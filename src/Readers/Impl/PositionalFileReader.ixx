@@ -0,0 +1,35 @@
+export module Saturn.Readers.PositionalFileReader;
+
+import <string>;
+import <cstdint>;
+
+// Read-only file handle that only does positional reads. There is no file pointer, so any number of
+// threads can read from one handle at once without locking. Nothing is mapped, so the file can still
+// be appended to or trimmed while it is open, reads past the current end simply fail.
+export class FPositionalFileReader {
+public:
+    FPositionalFileReader(const char* InFilename);
+    ~FPositionalFileReader();
+
+    FPositionalFileReader(const FPositionalFileReader&) = delete;
+    FPositionalFileReader& operator=(const FPositionalFileReader&) = delete;
+
+    // Reads exactly Length bytes at Offset, false if the file is shorter or the read failed
+    bool ReadAt(void* V, int64_t Length, int64_t Offset) const;
+    int64_t TotalSize() const;
+    bool IsValid() const;
+    void Close();
+
+#if !defined(_WIN32) && !defined(_WIN64)
+    // For async backends that submit reads to the kernel themselves
+    int GetFileDescriptor() const { return fd; }
+#endif
+private:
+    std::string FilePath;
+
+#if defined(_WIN32) || defined(_WIN64)
+    void* hFile = ((void*)(long long)-1);
+#else
+    int fd = -1;
+#endif
+};
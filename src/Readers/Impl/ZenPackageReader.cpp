@@ -266,31 +266,31 @@ FZenPackageSummary* FZenPackageReader::GetPackageSummary() {
     return PackageHeader.PackageSummary;
 }
 
-std::vector<uint64_t>& FZenPackageReader::GetImportedPublicExportHashes() {
+std::span<uint64_t> FZenPackageReader::GetImportedPublicExportHashes() {
     return PackageHeader.ImportedPublicExportHashes;
 }
 
-std::vector<FPackageObjectIndex>& FZenPackageReader::GetImportMap() {
+std::span<FPackageObjectIndex> FZenPackageReader::GetImportMap() {
     return PackageHeader.ImportMap;
 }
 
-std::vector<FExportMapEntry>& FZenPackageReader::GetExportMap() {
+std::span<FExportMapEntry> FZenPackageReader::GetExportMap() {
     return PackageHeader.ExportMap;
 }
 
-std::vector<FBulkDataMapEntry>& FZenPackageReader::GetBulkDataMap() {
+std::span<FBulkDataMapEntry> FZenPackageReader::GetBulkDataMap() {
     return PackageHeader.BulkDataMap;
 }
 
-std::vector<FExportBundleEntry>& FZenPackageReader::GetExportBundleEntries() {
+std::span<FExportBundleEntry> FZenPackageReader::GetExportBundleEntries() {
     return PackageHeader.ExportBundleEntries;
 }
 
-std::vector<FDependencyBundleHeader>& FZenPackageReader::GetDependencyBundleHeaders() {
+std::span<FDependencyBundleHeader> FZenPackageReader::GetDependencyBundleHeaders() {
     return PackageHeader.DependencyBundleHeaders;
 }
 
-std::vector<FDependencyBundleEntry>& FZenPackageReader::GetDependencyBundleEntries() {
+std::span<FDependencyBundleEntry> FZenPackageReader::GetDependencyBundleEntries() {
     return PackageHeader.DependencyBundleEntries;
 }
 
@@ -4,6 +4,7 @@ module;
 
 export module Saturn.Readers.ZenPackageReader;
 
+import <span>;
 import <string>;
 import <vector>;
 import <cstdint>;
@@ -78,16 +79,17 @@ public:
 export class FZenPackageReader : public FMemoryReader {
 public:
     FZenPackageReader() : FMemoryReader(nullptr, 0) {} // DO NOT USE THIS
-    FZenPackageReader(FIoBuffer& buffer) : FMemoryReader(buffer.GetData(), buffer.GetSize()) {
+    // Keeps a reference to the buffer, the package header is a view into it
+    FZenPackageReader(FIoBuffer& buffer) : FMemoryReader(buffer.GetData(), buffer.GetSize()), Buffer(buffer) {
         std::string OutError;
-        std::vector<uint8_t> bufferAsVector(buffer.GetData(), buffer.GetData() + buffer.GetSize());
-        PackageHeader = FZenPackageHeader::MakeView(bufferAsVector, OutError);
+        PackageHeader = FZenPackageHeader::MakeView(std::span<uint8_t>(Buffer.GetData(), Buffer.GetSize()), OutError);
 
         if (!OutError.empty()) {
             Status = FIoStatus(EIoErrorCode::ReadError, OutError);
         }
     }
 
+    // The caller owns the memory and has to keep it alive for as long as the reader
     FZenPackageReader(std::vector<uint8_t>& buffer) : FMemoryReader(buffer) {
         std::string OutError;
         PackageHeader = FZenPackageHeader::MakeView(buffer, OutError);
@@ -99,8 +101,7 @@ public:
 
     FZenPackageReader(uint8_t* buffer, size_t bufferLen) : FMemoryReader(buffer, bufferLen) {
         std::string OutError;
-        std::vector<uint8_t> bufferAsVector(buffer, buffer + bufferLen);
-        PackageHeader = FZenPackageHeader::MakeView(bufferAsVector, OutError);
+        PackageHeader = FZenPackageHeader::MakeView(std::span<uint8_t>(buffer, bufferLen), OutError);
 
         if (!OutError.empty()) {
             Status = FIoStatus(EIoErrorCode::ReadError, OutError);
@@ -118,13 +119,13 @@ public:
     class FNameMap& GetNameMap();
     std::wstring& GetPackageName();
     class FZenPackageSummary* GetPackageSummary();
-    std::vector<uint64_t>& GetImportedPublicExportHashes();
-    std::vector<class FPackageObjectIndex>& GetImportMap();
-    std::vector<class FExportMapEntry>& GetExportMap();
-    std::vector<class FBulkDataMapEntry>& GetBulkDataMap();
-    std::vector<class FExportBundleEntry>& GetExportBundleEntries();
-    std::vector<class FDependencyBundleHeader>& GetDependencyBundleHeaders();
-    std::vector<class FDependencyBundleEntry>& GetDependencyBundleEntries();
+    std::span<uint64_t> GetImportedPublicExportHashes();
+    std::span<class FPackageObjectIndex> GetImportMap();
+    std::span<class FExportMapEntry> GetExportMap();
+    std::span<class FBulkDataMapEntry> GetBulkDataMap();
+    std::span<class FExportBundleEntry> GetExportBundleEntries();
+    std::span<class FDependencyBundleHeader> GetDependencyBundleHeaders();
+    std::span<class FDependencyBundleEntry> GetDependencyBundleEntries();
     std::vector<std::wstring>& GetImportedPackageNames();
 
     std::vector<uint8_t> SerializeAsByteArray(std::vector<uint8_t>& Original);
@@ -172,6 +173,7 @@ public:
 private:
     FIoStatus Status = FIoStatus::Ok;
 
+    FIoBuffer Buffer;
     FZenPackageHeader PackageHeader;
 
     TSharedPtr<struct FZenPackageData> PackageData;
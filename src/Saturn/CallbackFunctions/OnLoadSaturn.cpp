@@ -120,6 +120,9 @@ JSValueRef FOnLoadSaturn::OnLoadSaturn(JSContextRef ctx, JSObjectRef function, J
 	FContext::Provider = std::make_shared<FFileProvider>(FortniteFunctionLibrary::GetFortniteInstallationPath(), mappingsPath + std::get<1>(mappings));
 
 	LOG_INFO("Created provider");
+
+	std::wstring mountSnapshotPathW = WindowsFunctionLibrary::GetSaturnLocalPath() + L"\\MountSnapshot.bin";
+	FContext::Provider->SetMountSnapshotPath(std::string(mountSnapshotPathW.begin(), mountSnapshotPathW.end()));
 	FContext::Provider->SubmitKey(defaultGUID, defaultAES);
 	LOG_INFO("Submited default key");
 	FContext::Provider->MountAsync();
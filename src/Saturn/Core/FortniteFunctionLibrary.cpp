@@ -24,6 +24,7 @@ import Saturn.Structs.FileInfo;
 import Saturn.Readers.FileReader;
 import Saturn.Items.LoadoutModel;
 import Saturn.Paths.SoftObjectPath;
+import Saturn.IoStore.IoBlockCache;
 import Saturn.IoStore.IoStoreReader;
 import Saturn.WindowsFunctionLibrary;
 import Saturn.Structs.IoOffsetLength;
@@ -280,6 +281,10 @@ bool FortniteFunctionLibrary::PatchFortnite(const FLoadout& Loadout) {
 
 		Ar.Close();
 
+		// The in-memory TOC now points at the appended blocks, anything decoded from the old ones is stale
+		FIoBlockCache::Get().InvalidateContainer(toc.Header.ContainerId.Value());
+		FContext::Provider->GetPackageCache().Clear();
+
 		std::string containerName = reader->GetContainerName();
 		toc.ChunkOffsetAndLengths[TocEntryIndex].SetLength(bufferToWrite.size());
 
@@ -2,9 +2,11 @@ import Saturn.ZenPackage.ZenPackageHeader;
 
 #include "Saturn/Log.h"
 
+import <span>;
 import <string>;
 import <vector>;
 import <cstdint>;
+import <algorithm>;
 
 import Saturn.Asset.NameMap;
 import Saturn.Structs.MappedName;
@@ -18,7 +20,12 @@ import Saturn.Asset.DependencyBundleHeader;
 import Saturn.ZenPackage.ZenPackageSummary;
 import Saturn.ZenPackage.ZenPackageImportedPackageNamesContainer;
 
-FZenPackageHeader FZenPackageHeader::MakeView(std::vector<uint8_t>& Memory) {
+template <typename T>
+static std::span<T> MakeArrayView(uint8_t* Base, uint64_t BeginOffset, uint64_t EndOffset) {
+    return std::span<T>(reinterpret_cast<T*>(Base + BeginOffset), (EndOffset - BeginOffset) / sizeof(T));
+}
+
+FZenPackageHeader FZenPackageHeader::MakeView(std::span<uint8_t> Memory) {
     std::string Error;
     FZenPackageHeader Result = MakeView(Memory, Error);
     if (!Error.empty()) {
@@ -27,23 +34,49 @@ FZenPackageHeader FZenPackageHeader::MakeView(std::vector<uint8_t>& Memory) {
     return Result;
 }
 
-FZenPackageHeader FZenPackageHeader::MakeView(std::vector<uint8_t>& Memory, std::string& OutError) {
+FZenPackageHeader FZenPackageHeader::MakeView(std::span<uint8_t> Memory, std::string& OutError) {
     OutError.clear();
 
     FZenPackageHeader PackageHeader;
-    uint8_t* PackageHeaderDataPtr = reinterpret_cast<uint8_t*>(Memory.data());
-    PackageHeader.PackageSummary = std::move(reinterpret_cast<FZenPackageSummary*>(PackageHeaderDataPtr));
+    if (Memory.size() < sizeof(FZenPackageSummary)) {
+        OutError = "Zen package is smaller than its summary";
+        return PackageHeader;
+    }
 
-    std::vector<uint8_t> PackageHeaderDataView(PackageHeaderDataPtr + sizeof(FZenPackageSummary), PackageHeaderDataPtr + PackageHeader.PackageSummary->HeaderSize - sizeof(FZenPackageSummary));
-    FMemoryReader PackageHeaderDataReader(PackageHeaderDataView);
-    if (PackageHeader.PackageSummary->bHasVersioningInfo) {
+    uint8_t* PackageHeaderDataPtr = Memory.data();
+    PackageHeader.PackageSummary = reinterpret_cast<FZenPackageSummary*>(PackageHeaderDataPtr);
+
+    // Every map below is a view into Memory, so make sure the summary's offsets stay inside it first
+    const FZenPackageSummary& Summary = *PackageHeader.PackageSummary;
+    const uint64_t Offsets[] = {
+        sizeof(FZenPackageSummary),
+        Summary.ImportedPublicExportHashesOffset,
+        Summary.ImportMapOffset,
+        Summary.ExportMapOffset,
+        Summary.ExportBundleEntriesOffset,
+        Summary.DependencyBundleHeadersOffset,
+        Summary.DependencyBundleEntriesOffset,
+        static_cast<uint64_t>(std::max(Summary.ImportedPackageNamesOffset, 0)),
+        Summary.HeaderSize,
+        Memory.size()
+    };
+    for (size_t Index = 1; Index < std::size(Offsets); ++Index) {
+        if (Offsets[Index] < Offsets[Index - 1]) {
+            OutError = "Corrupt Zen header offsets";
+            PackageHeader.PackageSummary = nullptr;
+            return PackageHeader;
+        }
+    }
+
+    FMemoryReader PackageHeaderDataReader(PackageHeaderDataPtr + sizeof(FZenPackageSummary), Summary.HeaderSize - sizeof(FZenPackageSummary));
+    if (Summary.bHasVersioningInfo) {
         // We actually do not have this done yet bc fortnite doesn't use it
     }
 
     {
         PackageHeader.NameMap.Load(PackageHeaderDataReader, FMappedName::EType::Package);
     }
-    PackageHeader.PackageName = PackageHeader.NameMap.GetName(PackageHeader.PackageSummary->Name);
+    PackageHeader.PackageName = PackageHeader.NameMap.GetName(Summary.Name);
 
     int64_t BulkDataMapSize = 0;
     uint64_t BulkDataPad = 0;
@@ -51,16 +84,20 @@ FZenPackageHeader FZenPackageHeader::MakeView(std::vector<uint8_t>& Memory, std:
     uint8_t PadBytes[sizeof(uint64_t)] = {};
     PackageHeaderDataReader.Serialize(PadBytes, BulkDataPad);
     PackageHeaderDataReader << BulkDataMapSize;
-    uint8_t* BulkDataMapData = PackageHeaderDataPtr + sizeof(FZenPackageSummary) + PackageHeaderDataReader.Tell();
-    PackageHeader.BulkDataMap = std::vector<FBulkDataMapEntry>(reinterpret_cast<FBulkDataMapEntry*>(BulkDataMapData), reinterpret_cast<FBulkDataMapEntry*>(BulkDataMapData + BulkDataMapSize));
+    const uint64_t BulkDataMapOffset = sizeof(FZenPackageSummary) + PackageHeaderDataReader.Tell();
+    if (BulkDataMapSize < 0 || BulkDataMapOffset + BulkDataMapSize > Summary.ImportedPublicExportHashesOffset) {
+        OutError = "Corrupt bulk data map in package " + std::string(PackageHeader.PackageName.begin(), PackageHeader.PackageName.end());
+        return PackageHeader;
+    }
+    PackageHeader.BulkDataMap = MakeArrayView<FBulkDataMapEntry>(PackageHeaderDataPtr, BulkDataMapOffset, BulkDataMapOffset + BulkDataMapSize);
 
-    PackageHeader.CookedHeaderSize = PackageHeader.PackageSummary->CookedHeaderSize;
-    PackageHeader.ImportedPublicExportHashes = std::vector<uint64_t>(reinterpret_cast<uint64_t*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ImportedPublicExportHashesOffset), reinterpret_cast<uint64_t*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ImportMapOffset));
-    PackageHeader.ImportMap = std::vector<FPackageObjectIndex>(reinterpret_cast<FPackageObjectIndex*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ImportMapOffset), reinterpret_cast<FPackageObjectIndex*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ExportMapOffset));
-    PackageHeader.ExportMap = std::vector<FExportMapEntry>(reinterpret_cast<FExportMapEntry*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ExportMapOffset), reinterpret_cast<FExportMapEntry*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ExportBundleEntriesOffset));
+    PackageHeader.CookedHeaderSize = Summary.CookedHeaderSize;
+    PackageHeader.ImportedPublicExportHashes = MakeArrayView<uint64_t>(PackageHeaderDataPtr, Summary.ImportedPublicExportHashesOffset, Summary.ImportMapOffset);
+    PackageHeader.ImportMap = MakeArrayView<FPackageObjectIndex>(PackageHeaderDataPtr, Summary.ImportMapOffset, Summary.ExportMapOffset);
+    PackageHeader.ExportMap = MakeArrayView<FExportMapEntry>(PackageHeaderDataPtr, Summary.ExportMapOffset, Summary.ExportBundleEntriesOffset);
     PackageHeader.ExportCount = PackageHeader.ExportMap.size();
 
-    const uint64_t ExportBundleEntriesSize = PackageHeader.PackageSummary->DependencyBundleHeadersOffset - PackageHeader.PackageSummary->ExportBundleEntriesOffset;
+    const uint64_t ExportBundleEntriesSize = Summary.DependencyBundleHeadersOffset - Summary.ExportBundleEntriesOffset;
     const int32_t ExportBundleEntriesCount = static_cast<int32_t>(ExportBundleEntriesSize / sizeof(FExportBundleEntry));
 
     if (ExportBundleEntriesCount != PackageHeader.ExportCount * FExportBundleEntry::ExportCommandType_Count) {
@@ -68,18 +105,18 @@ FZenPackageHeader FZenPackageHeader::MakeView(std::vector<uint8_t>& Memory, std:
         return PackageHeader;
     }
 
-    PackageHeader.ExportBundleEntries = std::vector<FExportBundleEntry>(reinterpret_cast<FExportBundleEntry*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ExportBundleEntriesOffset), reinterpret_cast<FExportBundleEntry*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ExportBundleEntriesOffset + (sizeof(FExportBundleEntry) * ExportBundleEntriesCount)));
-    PackageHeader.DependencyBundleHeaders = std::vector<FDependencyBundleHeader>(reinterpret_cast<FDependencyBundleHeader*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->DependencyBundleHeadersOffset), reinterpret_cast<FDependencyBundleHeader*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->DependencyBundleEntriesOffset));
-    PackageHeader.DependencyBundleEntries = std::vector<FDependencyBundleEntry>(reinterpret_cast<FDependencyBundleEntry*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->DependencyBundleEntriesOffset), reinterpret_cast<FDependencyBundleEntry*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ImportedPackageNamesOffset));
+    PackageHeader.ExportBundleEntries = MakeArrayView<FExportBundleEntry>(PackageHeaderDataPtr, Summary.ExportBundleEntriesOffset, Summary.ExportBundleEntriesOffset + sizeof(FExportBundleEntry) * ExportBundleEntriesCount);
+    PackageHeader.DependencyBundleHeaders = MakeArrayView<FDependencyBundleHeader>(PackageHeaderDataPtr, Summary.DependencyBundleHeadersOffset, Summary.DependencyBundleEntriesOffset);
+    PackageHeader.DependencyBundleEntries = MakeArrayView<FDependencyBundleEntry>(PackageHeaderDataPtr, Summary.DependencyBundleEntriesOffset, Summary.ImportedPackageNamesOffset);
 
-    std::vector<uint8_t> ImportedPackageNamesDataView = std::vector<uint8_t>(reinterpret_cast<uint8_t*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ImportedPackageNamesOffset), reinterpret_cast<uint8_t*>(PackageHeaderDataPtr + PackageHeader.PackageSummary->ImportedPackageNamesOffset + PackageHeader.PackageSummary->HeaderSize - PackageHeader.PackageSummary->ImportedPackageNamesOffset));
-    FMemoryReader ImportedPackageNamesDataReader(ImportedPackageNamesDataView);
+    FMemoryReader ImportedPackageNamesDataReader(PackageHeaderDataPtr + Summary.ImportedPackageNamesOffset, Summary.HeaderSize - Summary.ImportedPackageNamesOffset);
     FZenPackageImportedPackageNamesContainer Container;
     ImportedPackageNamesDataReader << Container;
     PackageHeader.ImportedPackageNames = std::move(Container.Names);
 
-    PackageHeader.ExportOffset = PackageHeader.PackageSummary->HeaderSize;
+    PackageHeader.ExportOffset = Summary.HeaderSize;
 
+    PackageHeader.ImportedPackageIds.reserve(PackageHeader.ImportedPackageNames.size());
     for (std::wstring& nameW : PackageHeader.ImportedPackageNames) {
         std::string name(nameW.begin(), nameW.end());
         PackageHeader.ImportedPackageIds.push_back(FPackageId::FromName(name));
@@ -90,11 +127,11 @@ FZenPackageHeader FZenPackageHeader::MakeView(std::vector<uint8_t>& Memory, std:
 
 void FZenPackageHeader::Reset() {
     PackageSummary = nullptr;
-    ImportedPublicExportHashes = std::vector<uint64_t>();
-    ImportMap = std::vector<FPackageObjectIndex>();
-    ExportMap = std::vector<FExportMapEntry>();
-    BulkDataMap = std::vector<FBulkDataMapEntry>();
-    ExportBundleEntries = std::vector<FExportBundleEntry>();
-    DependencyBundleHeaders = std::vector<FDependencyBundleHeader>();
-    DependencyBundleEntries = std::vector<FDependencyBundleEntry>();
+    ImportedPublicExportHashes = {};
+    ImportMap = {};
+    ExportMap = {};
+    BulkDataMap = {};
+    ExportBundleEntries = {};
+    DependencyBundleHeaders = {};
+    DependencyBundleEntries = {};
 }
@@ -1,5 +1,6 @@
 export module Saturn.ZenPackage.ZenPackageHeader;
 
+import <span>;
 import <vector>;
 import <string>;
 import <cstdint>;
@@ -24,21 +25,21 @@ export struct FZenPackageHeader {
     FNameMap NameMap;
     std::wstring PackageName;
 
-    // Backend by IoBuffer
+    // Views into the package buffer, which has to outlive the header (FZenPackageReader owns it)
     FZenPackageSummary* PackageSummary = nullptr;
-    std::vector<uint64_t> ImportedPublicExportHashes;
-    std::vector<FPackageObjectIndex> ImportMap;
-    std::vector<FExportMapEntry> ExportMap;
-    std::vector<FBulkDataMapEntry> BulkDataMap;
-    std::vector<FExportBundleEntry> ExportBundleEntries;
-    std::vector<FDependencyBundleHeader> DependencyBundleHeaders;
-    std::vector<FDependencyBundleEntry> DependencyBundleEntries;
+    std::span<uint64_t> ImportedPublicExportHashes;
+    std::span<FPackageObjectIndex> ImportMap;
+    std::span<FExportMapEntry> ExportMap;
+    std::span<FBulkDataMapEntry> BulkDataMap;
+    std::span<FExportBundleEntry> ExportBundleEntries;
+    std::span<FDependencyBundleHeader> DependencyBundleHeaders;
+    std::span<FDependencyBundleEntry> DependencyBundleEntries;
 
     std::vector<FPackageId> ImportedPackageIds;
     std::vector<std::wstring> ImportedPackageNames;
     uint32_t ExportOffset = 0;
 
-    static FZenPackageHeader MakeView(std::vector<uint8_t>& Memory);
-    static FZenPackageHeader MakeView(std::vector<uint8_t>& Memory, std::string& OutError);
+    static FZenPackageHeader MakeView(std::span<uint8_t> Memory);
+    static FZenPackageHeader MakeView(std::span<uint8_t> Memory, std::string& OutError);
     void Reset();
 };
\ No newline at end of file
@@ -2,6 +2,166 @@ import Saturn.Compression;
 import Saturn.Compression.Oodle;
 
 import <string>;
+import <cstring>;
+
+// miniz itself is compiled as part of the zip helpers, only its declarations are wanted here. The zip_file
+// classes after them define non-inline functions, renaming their namespace keeps them from clashing at link time.
+#define MINIZ_HEADER_FILE_ONLY
+#define miniz_cpp miniz_cpp_compression
+#include <miniz/zip_file.hpp>
+#undef miniz_cpp
+#undef MINIZ_HEADER_FILE_ONLY
+
+#define GZIP_HEADER_SIZE 10
+#define GZIP_FOOTER_SIZE 8
+#define GZIP_FLAG_HCRC 0x02
+#define GZIP_FLAG_EXTRA 0x04
+#define GZIP_FLAG_NAME 0x08
+#define GZIP_FLAG_COMMENT 0x10
+
+#define LZ4_MIN_MATCH 4
+
+static bool DecompressNone(void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize) {
+	if (UncompressedSize > CompressedSize) {
+		return false;
+	}
+
+	memcpy(UncompressedBuffer, CompressedBuffer, UncompressedSize);
+	return true;
+}
+
+static bool DecompressZlib(void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize) {
+	size_t Written = tinfl_decompress_mem_to_mem(UncompressedBuffer, UncompressedSize, CompressedBuffer, CompressedSize, TINFL_FLAG_PARSE_ZLIB_HEADER);
+	return Written == static_cast<size_t>(UncompressedSize);
+}
+
+// A gzip member is a deflate stream wrapped in a variable size header and a crc32 + size footer
+static bool DecompressGzip(void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize) {
+	const uint8_t* Src = static_cast<const uint8_t*>(CompressedBuffer);
+	if (CompressedSize < GZIP_HEADER_SIZE + GZIP_FOOTER_SIZE || Src[0] != 0x1F || Src[1] != 0x8B || Src[2] != 8) {
+		return false;
+	}
+
+	const uint8_t Flags = Src[3];
+	const uint8_t* SrcEnd = Src + CompressedSize - GZIP_FOOTER_SIZE;
+	const uint8_t* Cur = Src + GZIP_HEADER_SIZE;
+
+	if (Flags & GZIP_FLAG_EXTRA) {
+		if (SrcEnd - Cur < 2) {
+			return false;
+		}
+		Cur += 2 + (Cur[0] | (Cur[1] << 8));
+	}
+	if (Flags & GZIP_FLAG_NAME) {
+		while (Cur < SrcEnd && *Cur++ != 0);
+	}
+	if (Flags & GZIP_FLAG_COMMENT) {
+		while (Cur < SrcEnd && *Cur++ != 0);
+	}
+	if (Flags & GZIP_FLAG_HCRC) {
+		Cur += 2;
+	}
+	if (Cur > SrcEnd) {
+		return false;
+	}
+
+	size_t Written = tinfl_decompress_mem_to_mem(UncompressedBuffer, UncompressedSize, Cur, SrcEnd - Cur, 0);
+	if (Written != static_cast<size_t>(UncompressedSize)) {
+		return false;
+	}
+
+	uint32_t ExpectedCrc, ExpectedSize;
+	memcpy(&ExpectedCrc, SrcEnd, sizeof(uint32_t));
+	memcpy(&ExpectedSize, SrcEnd + sizeof(uint32_t), sizeof(uint32_t));
+
+	return ExpectedSize == static_cast<uint32_t>(UncompressedSize)
+		&& ExpectedCrc == static_cast<uint32_t>(mz_crc32(0, static_cast<const uint8_t*>(UncompressedBuffer), UncompressedSize));
+}
+
+// LZ4 lengths of 15 continue in the following bytes, each 255 meaning another byte follows
+static bool ReadLZ4Length(const uint8_t*& Src, const uint8_t* SrcEnd, size_t& Length) {
+	uint8_t Byte;
+	do {
+		if (Src >= SrcEnd) {
+			return false;
+		}
+		Byte = *Src++;
+		Length += Byte;
+	} while (Byte == 255);
+
+	return true;
+}
+
+// Raw LZ4 block format, every access is bounds checked since the input comes straight from disk
+static bool DecompressLZ4(void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize) {
+	const uint8_t* Src = static_cast<const uint8_t*>(CompressedBuffer);
+	const uint8_t* const SrcEnd = Src + CompressedSize;
+	uint8_t* const DstStart = static_cast<uint8_t*>(UncompressedBuffer);
+	uint8_t* const DstEnd = DstStart + UncompressedSize;
+	uint8_t* Dst = DstStart;
+
+	while (Src < SrcEnd) {
+		const uint8_t Token = *Src++;
+
+		size_t LiteralLength = Token >> 4;
+		if (LiteralLength == 15 && !ReadLZ4Length(Src, SrcEnd, LiteralLength)) {
+			return false;
+		}
+		if (LiteralLength > static_cast<size_t>(SrcEnd - Src) || LiteralLength > static_cast<size_t>(DstEnd - Dst)) {
+			return false;
+		}
+
+		memcpy(Dst, Src, LiteralLength);
+		Src += LiteralLength;
+		Dst += LiteralLength;
+
+		// The last sequence only has literals
+		if (Src == SrcEnd) {
+			break;
+		}
+		if (SrcEnd - Src < 2) {
+			return false;
+		}
+
+		const size_t Offset = Src[0] | (Src[1] << 8);
+		Src += 2;
+		if (Offset == 0 || Offset > static_cast<size_t>(Dst - DstStart)) {
+			return false;
+		}
+
+		size_t MatchLength = Token & 0xF;
+		if (MatchLength == 15 && !ReadLZ4Length(Src, SrcEnd, MatchLength)) {
+			return false;
+		}
+		MatchLength += LZ4_MIN_MATCH;
+		if (MatchLength > static_cast<size_t>(DstEnd - Dst)) {
+			return false;
+		}
+
+		const uint8_t* Match = Dst - Offset;
+		if (Offset >= MatchLength) {
+			memcpy(Dst, Match, MatchLength);
+		}
+		else {
+			// Overlapping match repeats the last Offset bytes
+			for (size_t i = 0; i < MatchLength; i++) {
+				Dst[i] = Match[i];
+			}
+		}
+		Dst += MatchLength;
+	}
+
+	return Dst == DstEnd;
+}
+
+// Oodle::Decompress throws without the DLL, decoders report that as a failed block instead
+static bool DecompressOodle(void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize) {
+	if (!Oodle::IsLoaded()) {
+		return false;
+	}
+
+	return Oodle::Decompress(CompressedBuffer, CompressedSize, UncompressedBuffer, UncompressedSize);
+}
 
 bool FCompression::VerifyCompressionFlagsValid(int32_t InCompressionFlags) {
 	const int32_t CompressionFlagsMask = COMPRESS_DeprecatedFormatFlagsMask | COMPRESS_OptionsFlagsMask | COMPRESS_ForPurposeMask;
@@ -12,6 +172,37 @@ bool FCompression::VerifyCompressionFlagsValid(int32_t InCompressionFlags) {
 	return true;
 }
 
+ECompressionMethod FCompression::GetCompressionMethod(const std::string& FormatName) {
+	if (FormatName.empty() || FormatName.contains("None")) {
+		return ECompressionMethod::None;
+	}
+	else if (FormatName.contains("Zlib")) {
+		return ECompressionMethod::Zlib;
+	}
+	else if (FormatName.contains("Gzip")) {
+		return ECompressionMethod::Gzip;
+	}
+	else if (FormatName.contains("LZ4")) {
+		return ECompressionMethod::LZ4;
+	}
+	else if (FormatName.contains("Oodle")) {
+		return ECompressionMethod::Oodle;
+	}
+
+	return ECompressionMethod::Unknown;
+}
+
+FDecompressionFunc FCompression::GetDecompressor(ECompressionMethod Method) {
+	switch (Method) {
+	case ECompressionMethod::None: return DecompressNone;
+	case ECompressionMethod::Zlib: return DecompressZlib;
+	case ECompressionMethod::Gzip: return DecompressGzip;
+	case ECompressionMethod::LZ4: return DecompressLZ4;
+	case ECompressionMethod::Oodle: return DecompressOodle;
+	default: return nullptr;
+	}
+}
+
 int64_t FCompression::GetMaximumCompressedSize(const std::string& FormatName, int32_t UncompressedSize, ECompressionFlags Flags, int32_t CompressionData) {
 	if (FormatName == "Oodle") {
 		return Oodle::GetMaximumCompressedSize(UncompressedSize);
@@ -46,13 +237,13 @@ void FCompression::CompressMemory(const std::string& FormatName, const void* Unc
 	}
 
 	if (FormatName.contains("Zlib")) {
-		// TODO: Implement Zlib decompression
+		// TODO: Implement Zlib compression
 	}
 	else if (FormatName.contains("Gzip")) {
-		// TODO: Implement Gzip decompression
+		// TODO: Implement Gzip compression
 	}
 	else if (FormatName.contains("LZ4")) {
-		// TODO: Implement LZ4 decompression
+		// TODO: Implement LZ4 compression
 	}
 	else if (FormatName.contains("Oodle")) {
 		Oodle::Compress(CompressedBuffer, CompressedSize, UncompressedBuffer, UncompressedSize);
@@ -63,22 +254,16 @@ void FCompression::CompressMemory(const std::string& FormatName, const void* Unc
 	}
 }
 
-void FCompression::DecompressMemory(const std::string& FormatName, void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize) {
+bool FCompression::DecompressMemory(ECompressionMethod Method, void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize) {
 	if (UncompressedSize == CompressedSize) {
 		memcpy(UncompressedBuffer, CompressedBuffer, CompressedSize);
-		return;
+		return true;
 	}
 
-	if (FormatName.contains("Zlib")) {
-		// TODO: Implement Zlib decompression
-	}
-	else if (FormatName.contains("Gzip")) {
-		// TODO: Implement Gzip decompression
-	}
-	else if (FormatName.contains("LZ4")) {
-		// TODO: Implement LZ4 decompression
-	}
-	else if (FormatName.contains("Oodle")) {
-		Oodle::Decompress(CompressedBuffer, CompressedSize, UncompressedBuffer, UncompressedSize);
-	}
-}
\ No newline at end of file
+	FDecompressionFunc Decompressor = GetDecompressor(Method);
+	return Decompressor && Decompressor(UncompressedBuffer, UncompressedSize, CompressedBuffer, CompressedSize);
+}
+
+bool FCompression::DecompressMemory(const std::string& FormatName, void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize) {
+	return DecompressMemory(GetCompressionMethod(FormatName), UncompressedBuffer, UncompressedSize, CompressedBuffer, CompressedSize);
+}
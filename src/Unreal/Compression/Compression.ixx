@@ -34,11 +34,27 @@ export enum ECompressionFlags {
 	COMPRESS_ForPurposeMask = 0xF00,
 };
 
+// Compression methods we know how to decode, resolved from the method names stored in a container
+export enum class ECompressionMethod : uint8_t {
+	None,
+	Zlib,
+	Gzip,
+	LZ4,
+	Oodle,
+	Unknown
+};
+
+// Decodes one block, returns false if the data is corrupt or the decoder is unavailable
+export typedef bool(*FDecompressionFunc)(void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize);
+
 export class FCompression {
 public:
     static bool VerifyCompressionFlagsValid(int32_t InCompressionFlags);
+	static ECompressionMethod GetCompressionMethod(const std::string& FormatName);
+	static FDecompressionFunc GetDecompressor(ECompressionMethod Method);
 	static int64_t GetMaximumCompressedSize(const std::string& FormatName, int32_t UncompressedSize, ECompressionFlags Flags = COMPRESS_NoFlags, int32_t CompressionData = 0);
 	static int64_t CompressMemoryBound(const std::string& FormatName, int32_t UncompressedSize, ECompressionFlags Flags, int32_t CompressionData);
 	static void CompressMemory(const std::string& FormatName, const void* UncompressedBuffer, int32_t UncompressedSize, void* CompressedBuffer, int32_t* CompressedSize);
-	static void DecompressMemory(const std::string& FormatName, void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize);
+	static bool DecompressMemory(ECompressionMethod Method, void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize);
+	static bool DecompressMemory(const std::string& FormatName, void* UncompressedBuffer, int32_t UncompressedSize, const void* CompressedBuffer, int32_t CompressedSize);
 };
\ No newline at end of file
@@ -47,10 +47,10 @@ uint32_t Oodle::GetMaximumCompressedSize(uint32_t InUncompressedSize) {
 	return MaxCompressedSize;
 }
 
-void Oodle::Decompress(const void* compressedData, intptr_t compressedSize, void* decompressedData, intptr_t decompressedSize) {
+bool Oodle::Decompress(const void* compressedData, intptr_t compressedSize, void* decompressedData, intptr_t decompressedSize) {
 	if (!OodleLZ_Decompress) {
 		throw std::exception("OodleLZ_Decompress is called despite the DLL not being loaded!");
 	}
 
-	OodleLZ_Decompress(compressedData, compressedSize, decompressedData, decompressedSize, 1, 1, 0, 0, 0, 0, 0, nullptr, 0, 3);
+	return OodleLZ_Decompress(compressedData, compressedSize, decompressedData, decompressedSize, 1, 1, 0, 0, 0, 0, 0, nullptr, 0, 3) == decompressedSize;
 }
\ No newline at end of file
@@ -0,0 +1,275 @@
+import Saturn.Core.TaskExecutor;
+
+#include "Saturn/Log.h"
+
+#include <thread>
+#include <deque>
+#include <chrono>
+#include <algorithm>
+#include <iterator>
+#include <exception>
+#include <condition_variable>
+
+import <mutex>;
+import <atomic>;
+import <memory>;
+import <vector>;
+import <functional>;
+
+// Owning executor and queue index of the current thread, if it's a worker
+static thread_local FTaskExecutor* CurrentExecutor = nullptr;
+static thread_local uint32_t CurrentWorkerIndex = 0;
+
+void FTaskHandle::Wait() const {
+    if (!State) {
+        return;
+    }
+
+    FTaskExecutor& Executor = FTaskExecutor::Get();
+    while (!State->bCompleted.load(std::memory_order_acquire)) {
+        if (Executor.TryExecuteOne()) {
+            continue;
+        }
+
+        // Nothing to help with, the task is running somewhere else. Sleep until it signals, but
+        // wake up periodically in case it queued more work we could pick up.
+        std::unique_lock<std::mutex> Lock(State->Lock);
+        State->Condition.wait_for(Lock, std::chrono::milliseconds(1), [this]() {
+            return State->bCompleted.load(std::memory_order_acquire);
+        });
+    }
+}
+
+FTaskExecutor::FTaskExecutor(uint32_t InNumWorkers) {
+    if (InNumWorkers == 0) {
+        InNumWorkers = 1;
+    }
+
+    MaxBackgroundWorkers = std::max(1u, InNumWorkers / 2);
+
+    Queues.reserve(InNumWorkers);
+    for (uint32_t i = 0; i < InNumWorkers; ++i) {
+        Queues.emplace_back(std::make_unique<FWorkerQueue>());
+    }
+
+    Workers.reserve(InNumWorkers);
+    for (uint32_t i = 0; i < InNumWorkers; ++i) {
+        Workers.emplace_back([this, i]() { WorkerMain(i); });
+    }
+}
+
+FTaskExecutor::~FTaskExecutor() {
+    {
+        std::lock_guard<std::mutex> Lock(SleepLock);
+        bStop = true;
+    }
+    SleepCondition.notify_all();
+
+    for (std::thread& Worker : Workers) {
+        Worker.join();
+    }
+
+    // Workers stop picking up background tasks once stopping. What's left is cancelled here rather than whenever the
+    // deque happens to be destroyed, so their captures are released before anything else is torn down.
+    std::deque<FBackgroundTask> CancelledTasks;
+    {
+        std::lock_guard<std::mutex> Lock(BackgroundLock);
+        CancelledTasks.swap(BackgroundTasks);
+        PendingBackgroundTasks.store(0, std::memory_order_relaxed);
+    }
+    CancelledTasks.clear();
+}
+
+FTaskExecutor& FTaskExecutor::Get() {
+    static FTaskExecutor Executor(std::max(2u, std::thread::hardware_concurrency()));
+    return Executor;
+}
+
+FTaskHandle FTaskExecutor::Launch(FTask&& Task) {
+    FTaskHandle Handle = MakePendingHandle();
+
+    Enqueue([Handle, Task = std::move(Task)]() mutable {
+        struct FCompleteOnExit {
+            const FTaskHandle& Handle;
+            ~FCompleteOnExit() { Complete(Handle); }
+        } CompleteOnExit { Handle };
+
+        Task();
+    });
+
+    return Handle;
+}
+
+FTaskHandle FTaskExecutor::MakePendingHandle() {
+    FTaskHandle Handle;
+    Handle.State = std::make_shared<FTaskHandle::FState>();
+    return Handle;
+}
+
+void FTaskExecutor::Complete(const FTaskHandle& Handle) {
+    if (!Handle.State) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> Lock(Handle.State->Lock);
+        Handle.State->bCompleted.store(true, std::memory_order_release);
+    }
+    Handle.State->Condition.notify_all();
+}
+
+void FTaskExecutor::Enqueue(FTask&& Task) {
+    uint32_t QueueIndex = CurrentExecutor == this
+        ? CurrentWorkerIndex
+        : NextQueueIndex.fetch_add(1, std::memory_order_relaxed) % Queues.size();
+
+    {
+        std::lock_guard<std::mutex> Lock(Queues[QueueIndex]->Lock);
+        Queues[QueueIndex]->Tasks.emplace_back(std::move(Task));
+    }
+
+    PendingTasks.fetch_add(1, std::memory_order_release);
+
+    // Taking the lock orders this against a worker that just checked PendingTasks and is about to sleep
+    { std::lock_guard<std::mutex> Lock(SleepLock); }
+    SleepCondition.notify_one();
+}
+
+void FTaskExecutor::EnqueueBackground(FTask&& Task, const void* Owner) {
+    {
+        std::lock_guard<std::mutex> Lock(BackgroundLock);
+        BackgroundTasks.push_back({ std::move(Task), Owner });
+    }
+
+    PendingBackgroundTasks.fetch_add(1, std::memory_order_release);
+
+    { std::lock_guard<std::mutex> Lock(SleepLock); }
+    SleepCondition.notify_one();
+}
+
+void FTaskExecutor::CancelBackground(const void* Owner) {
+    // Destroyed outside the lock, a task's captures may enqueue or cancel more work when they're released
+    std::deque<FBackgroundTask> CancelledTasks;
+    {
+        std::lock_guard<std::mutex> Lock(BackgroundLock);
+        auto Kept = std::stable_partition(BackgroundTasks.begin(), BackgroundTasks.end(), [Owner](const FBackgroundTask& BackgroundTask) {
+            return BackgroundTask.Owner != Owner;
+        });
+        std::move(Kept, BackgroundTasks.end(), std::back_inserter(CancelledTasks));
+        BackgroundTasks.erase(Kept, BackgroundTasks.end());
+        PendingBackgroundTasks.fetch_sub(static_cast<int32_t>(CancelledTasks.size()), std::memory_order_relaxed);
+    }
+    CancelledTasks.clear();
+}
+
+bool FTaskExecutor::TryExecuteOne() {
+    FTask Task;
+    if (!PopTask(Task)) {
+        return false;
+    }
+
+    Execute(Task);
+    return true;
+}
+
+bool FTaskExecutor::PopTask(FTask& OutTask) {
+    if (PendingTasks.load(std::memory_order_acquire) <= 0) {
+        return false;
+    }
+
+    const uint32_t QueueCount = static_cast<uint32_t>(Queues.size());
+    const bool bIsWorker = CurrentExecutor == this;
+    const uint32_t OwnIndex = bIsWorker ? CurrentWorkerIndex : NextQueueIndex.load(std::memory_order_relaxed) % QueueCount;
+
+    if (bIsWorker) {
+        FWorkerQueue& Own = *Queues[OwnIndex];
+        std::lock_guard<std::mutex> Lock(Own.Lock);
+        if (!Own.Tasks.empty()) {
+            OutTask = std::move(Own.Tasks.back());
+            Own.Tasks.pop_back();
+            PendingTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // Steal the oldest task from someone else
+    for (uint32_t Offset = bIsWorker ? 1 : 0; Offset < QueueCount; ++Offset) {
+        FWorkerQueue& Victim = *Queues[(OwnIndex + Offset) % QueueCount];
+        std::lock_guard<std::mutex> Lock(Victim.Lock);
+        if (!Victim.Tasks.empty()) {
+            OutTask = std::move(Victim.Tasks.front());
+            Victim.Tasks.pop_front();
+            PendingTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FTaskExecutor::PopBackgroundTask(FTask& OutTask) {
+    if (PendingBackgroundTasks.load(std::memory_order_acquire) <= 0) {
+        return false;
+    }
+
+    // Claim a background slot first, the worker that frees one picks up the next task itself
+    uint32_t Running = RunningBackgroundTasks.load(std::memory_order_relaxed);
+    do {
+        if (Running >= MaxBackgroundWorkers) {
+            return false;
+        }
+    } while (!RunningBackgroundTasks.compare_exchange_weak(Running, Running + 1, std::memory_order_acq_rel));
+
+    std::lock_guard<std::mutex> Lock(BackgroundLock);
+    if (BackgroundTasks.empty()) {
+        RunningBackgroundTasks.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    OutTask = std::move(BackgroundTasks.front().Task);
+    BackgroundTasks.pop_front();
+    PendingBackgroundTasks.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void FTaskExecutor::Execute(FTask& Task) {
+    // An escaping exception would take the whole worker down with it
+    try {
+        Task();
+    }
+    catch (const std::exception& Exception) {
+        LOG_ERROR("Unhandled exception in executor task: {0}", Exception.what());
+    }
+    catch (...) {
+        LOG_ERROR("Unhandled exception in executor task");
+    }
+}
+
+void FTaskExecutor::WorkerMain(uint32_t WorkerIndex) {
+    CurrentExecutor = this;
+    CurrentWorkerIndex = WorkerIndex;
+
+    while (true) {
+        FTask Task;
+        if (PopTask(Task)) {
+            Execute(Task);
+            continue;
+        }
+
+        if (!bStop && PopBackgroundTask(Task)) {
+            Execute(Task);
+            RunningBackgroundTasks.fetch_sub(1, std::memory_order_release);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> Lock(SleepLock);
+        SleepCondition.wait(Lock, [this]() {
+            return bStop || PendingTasks.load(std::memory_order_acquire) > 0
+                || (PendingBackgroundTasks.load(std::memory_order_acquire) > 0 && RunningBackgroundTasks.load(std::memory_order_acquire) < MaxBackgroundWorkers);
+        });
+
+        if (bStop && PendingTasks.load(std::memory_order_acquire) <= 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+module;
+
+#include <thread>
+#include <deque>
+#include <condition_variable>
+
+export module Saturn.Core.TaskExecutor;
+
+import <mutex>;
+import <atomic>;
+import <memory>;
+import <vector>;
+import <cstdint>;
+import <functional>;
+
+// Completion handle for a task launched on FTaskExecutor. Waiting on a handle helps execute
+// queued tasks instead of just blocking, so it's safe to wait from inside another task.
+export class FTaskHandle {
+public:
+    FTaskHandle() = default;
+
+    bool IsValid() const { return State != nullptr; }
+    bool IsCompleted() const { return !State || State->bCompleted.load(std::memory_order_acquire); }
+    void Wait() const;
+private:
+    friend class FTaskExecutor;
+
+    struct FState {
+        std::atomic_bool bCompleted { false };
+        std::mutex Lock;
+        std::condition_variable Condition;
+    };
+
+    std::shared_ptr<FState> State;
+};
+
+// Process-wide executor with a fixed set of workers. Each worker owns a deque: it pops its own work
+// from the back (LIFO, cache warm) and steals from the front of the other workers' deques when it runs dry.
+// Tasks launched from a worker go to that worker's deque, tasks launched from outside are spread round robin.
+export class FTaskExecutor {
+public:
+    using FTask = std::function<void()>;
+
+    explicit FTaskExecutor(uint32_t InNumWorkers);
+    ~FTaskExecutor();
+
+    FTaskExecutor(const FTaskExecutor&) = delete;
+    FTaskExecutor& operator=(const FTaskExecutor&) = delete;
+
+    static FTaskExecutor& Get();
+
+    // Queue a task and get a handle that completes once it has run
+    FTaskHandle Launch(FTask&& Task);
+
+    // Queue a task without a completion handle
+    void Enqueue(FTask&& Task);
+
+    // Queue a task that only runs when no regular task is waiting, e.g. prefetching. At most half of the workers
+    // run background tasks at a time, so regular work always finds a free worker soon. Waiting on a handle never
+    // helps with background tasks. Tasks still queued when the executor shuts down are cancelled: they are destroyed
+    // without running, so whatever they captured is released. Owner only tags the task for CancelBackground.
+    void EnqueueBackground(FTask&& Task, const void* Owner = nullptr);
+
+    // Destroys Owner's background tasks that haven't started yet, without running them. Ones already running
+    // aren't waited for.
+    void CancelBackground(const void* Owner);
+
+    // Handle for work that finishes outside the executor, e.g. an IO completion. It completes once passed to Complete.
+    static FTaskHandle MakePendingHandle();
+    static void Complete(const FTaskHandle& Handle);
+
+    // Run one queued task on the calling thread, returns false if there was nothing to run
+    bool TryExecuteOne();
+
+    uint32_t GetNumWorkers() const { return static_cast<uint32_t>(Workers.size()); }
+private:
+    struct FWorkerQueue {
+        std::mutex Lock;
+        std::deque<FTask> Tasks;
+    };
+
+    struct FBackgroundTask {
+        FTask Task;
+        const void* Owner = nullptr;
+    };
+
+    void WorkerMain(uint32_t WorkerIndex);
+    bool PopTask(FTask& OutTask);
+    bool PopBackgroundTask(FTask& OutTask);
+    void Execute(FTask& Task);
+
+    std::vector<std::unique_ptr<FWorkerQueue>> Queues;
+    std::vector<std::thread> Workers;
+    std::atomic_uint32_t NextQueueIndex { 0 };
+    std::atomic_int32_t PendingTasks { 0 };
+
+    std::mutex BackgroundLock;
+    std::deque<FBackgroundTask> BackgroundTasks;
+    std::atomic_int32_t PendingBackgroundTasks { 0 };
+    std::atomic_uint32_t RunningBackgroundTasks { 0 };
+    uint32_t MaxBackgroundWorkers = 1;
+
+    std::mutex SleepLock;
+    std::condition_variable SleepCondition;
+    std::atomic_bool bStop { false };
+};
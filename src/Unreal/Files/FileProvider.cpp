@@ -7,6 +7,9 @@ import <iostream>;
 
 import <vector>;
 import <future>;
+import <charconv>;
+import <algorithm>;
+import <optional>;
 import <filesystem>;
 
 import Saturn.Core.ThreadPool;
@@ -18,9 +21,38 @@ import Saturn.Reflection.Mappings;
 
 import Saturn.Core.IoStatus;
 import Saturn.VFS.FileSystem;
+import Saturn.Files.PackageId;
+import Saturn.Files.MountSnapshot;
 import Saturn.IoStore.IoStoreReader;
+import Saturn.IoStore.IoBlockCache;
+import Saturn.Structs.IoChunkId;
+import Saturn.Structs.IoStoreTocResource;
 import Saturn.Readers.ZenPackageReader;
 
+// The pak order UE mounts containers with. Patch containers ("<Name>_P") override what they patch, and
+// versioned patches ("<Name>_<Version>_P") override older versions.
+static uint32_t GetPakOrder(const std::string& ArchivePath) {
+    std::string Name = std::filesystem::path(ArchivePath).filename().string();
+    if (!Name.ends_with("_P")) {
+        return 0;
+    }
+
+    uint32_t ChunkVersion = 1;
+    const size_t VersionEnd = Name.size() - 2;
+    const size_t VersionStart = VersionEnd > 0 ? Name.rfind('_', VersionEnd - 1) : std::string::npos;
+    if (VersionStart != std::string::npos) {
+        const char* First = Name.data() + VersionStart + 1;
+        const char* Last = Name.data() + VersionEnd;
+
+        uint32_t Version = 0;
+        auto [End, Error] = std::from_chars(First, Last, Version);
+        if (First != Last && End == Last && Error == std::errc() && Version >= 1) {
+            ChunkVersion = Version + 1;
+        }
+    }
+    return 100 * ChunkVersion;
+}
+
 FFileProvider::FFileProvider(const std::string& PakDirectory, const std::string& MappingsFile) {
     VFS = std::make_shared<VirtualFileSystem>();
     Context = std::make_shared<GlobalContext>();
@@ -40,6 +72,13 @@ FFileProvider::FFileProvider(const std::string& PakDirectory, const std::string&
             }
         }
     }
+
+    // An archive's index is its mount order, so where several containers have the same file the one with the
+    // higher pak order wins. Ties go by path, so which file wins never depends on which archive mounted first.
+    std::sort(this->ArchivePaths.begin(), this->ArchivePaths.end(), [](const std::string& A, const std::string& B) {
+        const uint32_t OrderA = GetPakOrder(A), OrderB = GetPakOrder(B);
+        return OrderA != OrderB ? OrderA < OrderB : A < B;
+    });
 }
 
 void FFileProvider::SubmitKey(FGuid& Guid, FAESKey& Key) {
@@ -53,64 +92,124 @@ void FFileProvider::SubmitKeys(TMap<FGuid, FAESKey>& DecryptionKeys) {
 }
 
 void FFileProvider::MountAsync() {
-    ThreadPool pool(std::thread::hardware_concurrency());
-    std::vector<std::future<void>> futures;
-
-    for (const auto& Archive : ArchivePaths) {
-        futures.emplace_back(std::async(std::launch::async, [this, &pool, Archive]() {
-            pool.enqueue([this, Archive]() {
-                FIoStoreReader* reader = new FIoStoreReader();
-                FIoStatus status = reader->Initialize(Archive, this->DecryptionKeys);
-                if (!status.IsOk()) {
-                    LOG_WARN("Error: [{0}] while reading archive: '{1}'", status.ToString(), Archive);
-                    delete reader;
-                }
-                else {
-                    std::vector<std::pair<std::string, uint32_t>> Files;
-                    reader->GetFiles(Files);
-                    VFS->RegisterParallel(Files);
-                    VFS->RegisterReader(reader);
-
-                    if (reader->GetContainerName() == "global") {
-                        Context->GlobalToc = std::make_shared<FGlobalTocData>();
-                        Context->GlobalToc->Serialize(reader);
-                    }
-
-                    LOG_INFO("Successfully mounted archive: '{0}'", Archive);
-                    std::lock_guard<std::mutex> lock(this->TocArchivesMutex);
-                    this->TocArchives.emplace_back(reader);
-                }
-                });
-            }));
-    }
-
-    for (auto& future : futures) {
-        future.get();
-    }
+    FMountSnapshot Snapshot;
+    LoadMountSnapshot(Snapshot);
+
+    std::vector<FContainerSnapshotSource> Sources;
+    bool bParsedAny = false;
+    {
+        ThreadPool pool(std::thread::hardware_concurrency());
+        std::vector<std::future<void>> futures;
+
+        for (uint32_t MountOrder = 0; MountOrder < ArchivePaths.size(); MountOrder++) {
+            const std::string& Archive = ArchivePaths[MountOrder];
+            futures.emplace_back(std::async(std::launch::async, [this, &pool, &Snapshot, &Sources, &bParsedAny, Archive, MountOrder]() {
+                pool.enqueue([this, &Snapshot, &Sources, &bParsedAny, Archive, MountOrder]() {
+                    MountArchive(Archive, MountOrder, Snapshot, Sources, bParsedAny);
+                    });
+                }));
+        }
+
+        for (auto& future : futures) {
+            future.get();
+        }
+    } // The pool only finishes its queue when it's destroyed
+
+    SaveMountSnapshot(Snapshot, Sources, bParsedAny);
+    LogMountedFiles();
 }
 
 void FFileProvider::Mount() {
-    for (auto Archive : ArchivePaths) {
-        FIoStoreReader* reader = new FIoStoreReader();
-        FIoStatus status = reader->Initialize(Archive, this->DecryptionKeys);
-        if (!status.IsOk()) {
-            LOG_WARN("Error: [{0}] while reading archive: '{1}'", status.ToString(), Archive);
-        }
-        else {
-            std::vector<std::pair<std::string, uint32_t>> Files;
-            reader->GetFiles(Files);
-            VFS->RegisterParallel(Files);
-            VFS->RegisterReader(reader);
-
-            if (reader->GetContainerName() == "global") {
-                Context->GlobalToc = std::make_shared<FGlobalTocData>();
-                Context->GlobalToc->Serialize(reader);
-            }
+    FMountSnapshot Snapshot;
+    LoadMountSnapshot(Snapshot);
 
-            LOG_INFO("Successfully mounted archive: '{0}'", Archive);
-            this->TocArchives.emplace_back(reader);
+    std::vector<FContainerSnapshotSource> Sources;
+    bool bParsedAny = false;
+    for (uint32_t MountOrder = 0; MountOrder < ArchivePaths.size(); MountOrder++) {
+        MountArchive(ArchivePaths[MountOrder], MountOrder, Snapshot, Sources, bParsedAny);
+    }
+
+    SaveMountSnapshot(Snapshot, Sources, bParsedAny);
+    LogMountedFiles();
+}
+
+void FFileProvider::LoadMountSnapshot(FMountSnapshot& Snapshot) {
+    if (MountSnapshotPath.empty() || !std::filesystem::exists(MountSnapshotPath)) {
+        return;
+    }
+
+    FIoStatus status = Snapshot.Load(MountSnapshotPath);
+    if (!status.IsOk()) {
+        LOG_WARN("Ignoring mount snapshot: [{0}]", status.ToString());
+    }
+}
+
+void FFileProvider::SaveMountSnapshot(FMountSnapshot& Snapshot, const std::vector<FContainerSnapshotSource>& Sources, bool bParsedAny) {
+    // Nothing to write if every container came straight out of an up to date snapshot
+    if (MountSnapshotPath.empty() || (!bParsedAny && !Snapshot.IsOutdated())) {
+        return;
+    }
+
+    FIoStatus status = FMountSnapshot::Save(MountSnapshotPath, Sources);
+    if (!status.IsOk()) {
+        LOG_WARN("Failed to save mount snapshot: [{0}]", status.ToString());
+        return;
+    }
+
+    LOG_INFO("Saved mount snapshot of {0} archives to '{1}'", Sources.size(), MountSnapshotPath);
+}
+
+void FFileProvider::LogMountedFiles() const {
+    FVfsMemoryStats Stats = GetVfsMemoryStats();
+    LOG_INFO("Registered {0} files ({1} entries) in {2:.1f} MB, {3:.1f} bytes per file",
+        Stats.Files, Stats.Entries, Stats.GetTotalBytes() / (1024.0 * 1024.0), Stats.GetBytesPerFile());
+}
+
+void FFileProvider::MountArchive(const std::string& Archive, uint32_t MountOrder, FMountSnapshot& Snapshot, std::vector<FContainerSnapshotSource>& Sources, bool& bParsedAny) {
+    std::optional<FContainerFileStamp> Stamp;
+    std::optional<FContainerSnapshot> Cached;
+    if (!MountSnapshotPath.empty()) {
+        Stamp = FContainerFileStamp::FromContainer(Archive);
+        if (Stamp) {
+            Cached = Snapshot.Take(Archive, *Stamp);
         }
     }
+
+    FIoStoreReader* reader = new FIoStoreReader();
+    FIoStatus status = Cached
+        ? reader->Initialize(Archive, std::move(Cached->TocResource), this->DecryptionKeys)
+        : reader->Initialize(Archive, this->DecryptionKeys);
+
+    if (!status.IsOk()) {
+        LOG_WARN("Error: [{0}] while reading archive: '{1}'", status.ToString(), Archive);
+        delete reader;
+        return;
+    }
+
+    std::vector<FHashedGameFile> Files;
+    if (Cached) {
+        Files = std::move(Cached->Files);
+    }
+    else {
+        VirtualFileSystem::HashFiles(*reader, Files);
+    }
+
+    uint16_t ReaderId = VFS->RegisterReader(reader, MountOrder);
+    VFS->RegisterHashed(Files, ReaderId);
+
+    if (reader->GetContainerName() == "global") {
+        Context->GlobalToc = std::make_shared<FGlobalTocData>();
+        Context->GlobalToc->Serialize(reader);
+    }
+
+    LOG_INFO("Successfully mounted archive: '{0}'{1}", Archive, Cached ? " from snapshot" : "");
+    std::lock_guard<std::mutex> lock(this->TocArchivesMutex);
+    this->TocArchives.emplace_back(reader);
+
+    if (Stamp) {
+        Sources.push_back({ Archive, *Stamp, &reader->GetTocResource(), std::move(Files) });
+        bParsedAny |= !Cached;
+    }
 }
 
 void FFileProvider::Unmount() {
@@ -119,6 +218,8 @@ void FFileProvider::Unmount() {
     }
     TocArchives.clear();
     VFS->Clear();
+    PackageCache.Clear();
+    FIoBlockCache::Get().Clear();
 }
 
 UPackagePtr FFileProvider::LoadPackage(const std::string& Path) {
@@ -129,6 +230,19 @@ UPackagePtr FFileProvider::LoadPackage(const std::string& Path) {
 }
 
 UPackagePtr FFileProvider::LoadPackage(const std::string& Path, FExportState& State) {
+    // Partial loads and loads into a caller-provided target depend on the export state, so only plain
+    // full loads go through the package cache.
+    if (State.LoadTargetOnly || State.TargetObject) {
+        return LoadPackageUncached(Path, State);
+    }
+
+    FPackageId PackageId = FPackageId::FromName(VirtualFileSystem::GetPathWithoutExtension(Path));
+    return PackageCache.FindOrLoad(PackageId, [this, &Path, &State]() {
+        return LoadPackageUncached(Path, State);
+    });
+}
+
+UPackagePtr FFileProvider::LoadPackageUncached(const std::string& Path, FExportState& State) {
     std::string AssetPath = Path;
     TIoStatusOr<FIoBuffer> Entry = VFS->GetBufferByPathAndExtension(AssetPath);
 
@@ -147,6 +261,52 @@ UPackagePtr FFileProvider::LoadPackage(FIoBuffer& Entry, FExportState& State) {
     return reader.MakePackage(Context, State);
 }
 
+TSharedPtr<FIoPrefetchRequest> FFileProvider::Prefetch(const std::vector<std::string>& Paths) {
+    TSharedPtr<FIoPrefetchRequest> Request = std::make_shared<FIoPrefetchRequest>();
+    if (!VFS) {
+        return Request;
+    }
+
+    // One prefetch per container so neighbouring blocks of different files get read together
+    TMap<FIoStoreReader*, std::vector<FIoChunkId>> ChunksByReader;
+    for (const std::string& Path : Paths) {
+        FIoStoreReader* Reader = VFS->GetReaderByPathAndExtension(Path);
+        if (!Reader) {
+            continue;
+        }
+
+        ChunksByReader[Reader].push_back(Reader->GetTocResource().ChunkIds[VFS->GetTocEntryIndexByPathAndExtension(Path)]);
+    }
+
+    for (const auto& [Reader, ChunkIds] : ChunksByReader) {
+        Reader->Prefetch(ChunkIds, Request);
+    }
+    return Request;
+}
+
+std::vector<FIoVerifyResult> FFileProvider::VerifyContainers(const FIoVerifyOptions& Options) {
+    std::vector<FIoVerifyResult> Results;
+
+    std::lock_guard<std::mutex> Lock(TocArchivesMutex);
+    for (FIoStoreReader* Reader : TocArchives) {
+        TIoStatusOr<FIoVerifyResult> Result = Reader->Verify(Options);
+        if (!Result.IsOk()) {
+            LOG_WARN("Skipped verifying '{0}': {1}", Reader->GetContainerName(), Result.Status().ToString());
+            continue;
+        }
+
+        FIoVerifyResult Verified = Result.ConsumeValueOrDie();
+        if (Verified.IsOk()) {
+            LOG_INFO("Verified {0} chunks of '{1}' at {2:.1f} MB/s", Verified.VerifiedChunks, Verified.ContainerName, Verified.GetThroughput() / (1024 * 1024));
+        }
+        else {
+            LOG_ERROR("'{0}' has {1} corrupt and {2} unreadable chunks out of {3}", Verified.ContainerName, Verified.Mismatches.size(), Verified.FailedReads.size(), Verified.VerifiedChunks + Verified.FailedReads.size());
+        }
+        Results.push_back(std::move(Verified));
+    }
+    return Results;
+}
+
 FIoStoreReader* FFileProvider::GetReaderByPathAndExtension(const std::string& Path) {
     return VFS->GetReaderByPathAndExtension(Path);
 }
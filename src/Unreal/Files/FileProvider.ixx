@@ -15,6 +15,9 @@ import Saturn.Structs.Guid;
 import Saturn.VFS.FileSystem;
 import Saturn.Encryption.AES;
 import Saturn.Core.GlobalContext;
+import Saturn.Files.PackageCache;
+import Saturn.Files.MountSnapshot;
+import Saturn.IoStore.IoStoreReader;
 import Saturn.Readers.ZenPackageReader;
 
 export class FFileProvider {
@@ -25,6 +28,9 @@ public:
     void SubmitKey(FGuid& Guid, FAESKey& Key);
     void SubmitKeys(TMap<FGuid, FAESKey>& DecryptionKeys);
 
+    // Where the mount snapshot is read from and written to, an empty path always does a full mount
+    void SetMountSnapshotPath(const std::string& Path) { MountSnapshotPath = Path; }
+
     void MountAsync();
     void Mount();
     void Unmount();
@@ -32,6 +38,19 @@ public:
     UPackagePtr LoadPackage(const std::string& Path);
     UPackagePtr LoadPackage(const std::string& Path, FExportState& State);
     UPackagePtr LoadPackage(FIoBuffer& Entry, FExportState& State);
+
+    // Starts warming the block cache with the given files, e.g. the packages a swap is about to load.
+    // Paths are resolved like LoadPackage resolves them, unknown paths are skipped.
+    TSharedPtr<class FIoPrefetchRequest> Prefetch(const std::vector<std::string>& Paths);
+
+    // Checks every mounted container against the chunk hashes in its TOC and logs what didn't match.
+    // Containers too old to have blake3 chunk hashes are left out.
+    std::vector<FIoVerifyResult> VerifyContainers(const FIoVerifyOptions& Options = {});
+
+    FPackageCache& GetPackageCache() { return PackageCache; }
+
+    // How much memory the registered files take up in the virtual file system
+    FVfsMemoryStats GetVfsMemoryStats() const { return VFS ? VFS->GetMemoryStats() : FVfsMemoryStats{}; }
 public:
     std::vector<class FIoStoreReader*>& GetArchives() { return TocArchives; }
     class FIoStoreReader* GetReaderByPathAndExtension(const std::string& Path);
@@ -43,4 +62,13 @@ private:
     std::mutex TocArchivesMutex;
     TSharedPtr<GlobalContext> Context;
     TSharedPtr<VirtualFileSystem> VFS;
+    FPackageCache PackageCache;
+    std::string MountSnapshotPath;
+
+    void LoadMountSnapshot(FMountSnapshot& Snapshot);
+    void SaveMountSnapshot(FMountSnapshot& Snapshot, const std::vector<FContainerSnapshotSource>& Sources, bool bParsedAny);
+    void MountArchive(const std::string& Archive, uint32_t MountOrder, FMountSnapshot& Snapshot, std::vector<FContainerSnapshotSource>& Sources, bool& bParsedAny);
+    void LogMountedFiles() const;
+
+    UPackagePtr LoadPackageUncached(const std::string& Path, FExportState& State);
 };
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "Saturn/Defines.h"
+
+import Saturn.IoStore.IoBlockCache;
+
+import <list>;
+import <mutex>;
+import <memory>;
+import <vector>;
+import <cstdint>;
+
+FIoBlockCache::FIoBlockCache(uint64_t InBudgetBytes) : BudgetBytes(InBudgetBytes) {}
+
+FIoBlockCache& FIoBlockCache::Get() {
+    static FIoBlockCache Cache;
+    return Cache;
+}
+
+FIoBlockCache::FBlockRef FIoBlockCache::Find(const FIoBlockKey& Key) {
+    if (!IsEnabled()) {
+        return nullptr;
+    }
+
+    FShard& Shard = GetShard(Key);
+    {
+        std::lock_guard<std::mutex> Lock(Shard.Lock);
+        auto It = Shard.Lookup.find(Key);
+        if (It != Shard.Lookup.end()) {
+            Shard.Lru.splice(Shard.Lru.begin(), Shard.Lru, It->second);
+            Hits.fetch_add(1, std::memory_order_relaxed);
+            return It->second->Block;
+        }
+    }
+
+    Misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+uint64_t FIoBlockCache::GetGeneration(uint64_t ContainerId) const {
+    // Both only ever grow, so the sum changes whenever either does
+    return ClearGeneration.load(std::memory_order_acquire)
+        + GetGenerationSlot(ContainerId).load(std::memory_order_acquire);
+}
+
+void FIoBlockCache::Insert(const FIoBlockKey& Key, FBlockRef Block, uint64_t Generation) {
+    const uint64_t ShardBudget = GetBudget() / ShardCount;
+    if (!Block || Block->size() > ShardBudget) {
+        return;
+    }
+
+    FShard& Shard = GetShard(Key);
+    std::lock_guard<std::mutex> Lock(Shard.Lock);
+
+    // Invalidation bumps the generation before it locks the shards, so a block that got here first is dropped by
+    // it and one that comes after sees the new generation
+    if (GetGeneration(Key.ContainerId) != Generation) {
+        return;
+    }
+
+    auto It = Shard.Lookup.find(Key);
+    if (It != Shard.Lookup.end()) {
+        // Another reader decoded the same block concurrently, keep the existing one
+        Shard.Lru.splice(Shard.Lru.begin(), Shard.Lru, It->second);
+        return;
+    }
+
+    Shard.Bytes += Block->size();
+    Shard.Lru.push_front({ Key, std::move(Block) });
+    Shard.Lookup.insert({ Key, Shard.Lru.begin() });
+
+    EvictToBudget(Shard, ShardBudget);
+}
+
+void FIoBlockCache::Insert(const FIoBlockKey& Key, const uint8_t* Data, uint64_t Size, uint64_t Generation) {
+    if (!IsEnabled()) {
+        return;
+    }
+
+    Insert(Key, std::make_shared<const std::vector<uint8_t>>(Data, Data + Size), Generation);
+}
+
+void FIoBlockCache::EvictToBudget(FShard& Shard, uint64_t ShardBudget) {
+    while (Shard.Bytes > ShardBudget && !Shard.Lru.empty()) {
+        FEntry& Oldest = Shard.Lru.back();
+        Shard.Bytes -= Oldest.Block->size();
+        Shard.Lookup.erase(Oldest.Key);
+        Shard.Lru.pop_back();
+        Evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void FIoBlockCache::InvalidateContainer(uint64_t ContainerId) {
+    GetGenerationSlot(ContainerId).fetch_add(1, std::memory_order_acq_rel);
+
+    for (FShard& Shard : Shards) {
+        std::lock_guard<std::mutex> Lock(Shard.Lock);
+        for (auto It = Shard.Lru.begin(); It != Shard.Lru.end();) {
+            if (It->Key.ContainerId == ContainerId) {
+                Shard.Bytes -= It->Block->size();
+                Shard.Lookup.erase(It->Key);
+                It = Shard.Lru.erase(It);
+            }
+            else {
+                ++It;
+            }
+        }
+    }
+}
+
+void FIoBlockCache::Clear() {
+    ClearGeneration.fetch_add(1, std::memory_order_acq_rel);
+
+    for (FShard& Shard : Shards) {
+        std::lock_guard<std::mutex> Lock(Shard.Lock);
+        Shard.Lookup.clear();
+        Shard.Lru.clear();
+        Shard.Bytes = 0;
+    }
+}
+
+void FIoBlockCache::SetBudget(uint64_t InBudgetBytes) {
+    BudgetBytes.store(InBudgetBytes, std::memory_order_relaxed);
+
+    const uint64_t ShardBudget = InBudgetBytes / ShardCount;
+    for (FShard& Shard : Shards) {
+        std::lock_guard<std::mutex> Lock(Shard.Lock);
+        EvictToBudget(Shard, ShardBudget);
+    }
+}
+
+FIoBlockCacheStats FIoBlockCache::GetStats() const {
+    FIoBlockCacheStats Stats;
+    Stats.Hits = Hits.load(std::memory_order_relaxed);
+    Stats.Misses = Misses.load(std::memory_order_relaxed);
+    Stats.Evictions = Evictions.load(std::memory_order_relaxed);
+    Stats.BudgetBytes = GetBudget();
+
+    for (const FShard& Shard : Shards) {
+        std::lock_guard<std::mutex> Lock(Shard.Lock);
+        Stats.CachedBytes += Shard.Bytes;
+    }
+
+    return Stats;
+}
+
+void FIoBlockCache::ResetStats() {
+    Hits = 0;
+    Misses = 0;
+    Evictions = 0;
+}
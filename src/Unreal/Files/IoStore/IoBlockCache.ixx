@@ -0,0 +1,102 @@
+module;
+
+#include "Saturn/Defines.h"
+
+export module Saturn.IoStore.IoBlockCache;
+
+import <list>;
+import <mutex>;
+import <atomic>;
+import <memory>;
+import <vector>;
+import <cstdint>;
+
+export struct FIoBlockKey {
+    uint64_t ContainerId = 0;
+    int32_t BlockIndex = 0;
+
+    inline bool operator==(const FIoBlockKey& Other) const {
+        return ContainerId == Other.ContainerId && BlockIndex == Other.BlockIndex;
+    }
+
+    friend size_t hash_value(const FIoBlockKey& In) {
+        return size_t(In.ContainerId * 0x9E3779B97F4A7C15ull) ^ size_t(uint32_t(In.BlockIndex));
+    }
+};
+
+export struct FIoBlockCacheStats {
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t Evictions = 0;
+    uint64_t CachedBytes = 0;
+    uint64_t BudgetBytes = 0;
+};
+
+// Decrypted + decompressed IoStore compression blocks, keyed by (container id, block index).
+// The budget is split evenly across shards and each shard evicts least recently used blocks on its own,
+// so concurrent readers only contend when they hit the same shard.
+export class FIoBlockCache {
+public:
+    using FBlockRef = std::shared_ptr<const std::vector<uint8_t>>;
+
+    static constexpr uint32_t ShardCount = 16;
+    static constexpr uint64_t DefaultBudgetBytes = 256ull * 1024 * 1024;
+
+    explicit FIoBlockCache(uint64_t InBudgetBytes = DefaultBudgetBytes);
+
+    static FIoBlockCache& Get();
+
+    FBlockRef Find(const FIoBlockKey& Key);
+
+    // Changes whenever the container's blocks are invalidated or the cache is cleared. Take it before reading
+    // from disk and pass it to Insert, blocks decoded from data read before a newer generation are dropped.
+    uint64_t GetGeneration(uint64_t ContainerId) const;
+
+    void Insert(const FIoBlockKey& Key, FBlockRef Block, uint64_t Generation);
+    void Insert(const FIoBlockKey& Key, const uint8_t* Data, uint64_t Size, uint64_t Generation);
+
+    // Drops every block of a container, needed when its TOC is rewritten in place
+    void InvalidateContainer(uint64_t ContainerId);
+    void Clear();
+
+    // A budget of 0 disables the cache
+    void SetBudget(uint64_t InBudgetBytes);
+    uint64_t GetBudget() const { return BudgetBytes.load(std::memory_order_relaxed); }
+    bool IsEnabled() const { return GetBudget() != 0; }
+
+    FIoBlockCacheStats GetStats() const;
+    void ResetStats();
+private:
+    struct FEntry {
+        FIoBlockKey Key;
+        FBlockRef Block;
+    };
+
+    struct FShard {
+        mutable std::mutex Lock;
+        std::list<FEntry> Lru; // front is most recently used
+        TMap<FIoBlockKey, std::list<FEntry>::iterator> Lookup;
+        uint64_t Bytes = 0;
+    };
+
+    FShard& GetShard(const FIoBlockKey& Key) {
+        return Shards[hash_value(Key) % ShardCount];
+    }
+
+    void EvictToBudget(FShard& Shard, uint64_t ShardBudget);
+
+    // Containers share a slot when their ids collide, which only makes an insert get dropped needlessly
+    static constexpr uint32_t GenerationSlotCount = 256;
+
+    std::atomic_uint64_t& GetGenerationSlot(uint64_t ContainerId) const {
+        return ContainerGenerations[(ContainerId * 0x9E3779B97F4A7C15ull) >> 56];
+    }
+
+    FShard Shards[ShardCount];
+    mutable std::atomic_uint64_t ContainerGenerations[GenerationSlotCount] {};
+    std::atomic_uint64_t ClearGeneration { 0 };
+    std::atomic_uint64_t BudgetBytes;
+    std::atomic_uint64_t Hits { 0 };
+    std::atomic_uint64_t Misses { 0 };
+    std::atomic_uint64_t Evictions { 0 };
+};
@@ -1,5 +1,7 @@
 import Saturn.IoStore.IoDirectoryIndex;
 
+#include "Saturn/Defines.h"
+
 import Saturn.Core.IoStatus;
 import Saturn.Encryption.AES;
 import Saturn.Readers.FArchive;
@@ -8,7 +10,11 @@ import Saturn.Structs.IoFileIndexEntry;
 import Saturn.Structs.IoDirectoryIndexEntry;
 
 import <vector>;
+import <string>;
 import <cstdint>;
+import <algorithm>;
+import <string_view>;
+import <shared_mutex>;
 
 FArchive& operator<<(FArchive& Ar, FIoDirectoryIndexResource& DirectoryIndex) {
     Ar << DirectoryIndex.MountPoint;
@@ -21,16 +27,18 @@ FArchive& operator<<(FArchive& Ar, FIoDirectoryIndexResource& DirectoryIndex) {
 
 class FIoDirectoryIndexReaderImpl {
 public:
-    FIoStatus Initialize(std::vector<uint8_t>& InBuffer, FAESKey InDecryptionKey) {
+    FIoStatus Initialize(const std::vector<uint8_t>& InBuffer, FAESKey InDecryptionKey) {
         if (InBuffer.size() == 0) {
             return FIoStatus::Invalid;
         }
 
+        // Decrypt a copy so the TOC keeps the on-disk bytes, they're written back out when patching a container
+        std::vector<uint8_t> Buffer = InBuffer;
         if (InDecryptionKey.IsValid()) {
-            InDecryptionKey.DecryptData(InBuffer.data(), InBuffer.size());
+            InDecryptionKey.DecryptData(Buffer.data(), Buffer.size());
         }
 
-        FMemoryReader Ar(InBuffer);
+        FMemoryReader Ar(Buffer);
         Ar << DirectoryIndex;
 
         return FIoStatus::Ok;
@@ -88,49 +96,171 @@ public:
             : ~uint32_t(0);
     }
 
-    bool IterateDirectoryIndex(FIoDirectoryIndexHandle DirectoryIndexHandle, std::string Path, FDirectoryIndexVisitorFunction Visit) {
-        FIoDirectoryIndexHandle File = GetFile(DirectoryIndexHandle);
-        while (File.IsValid()) {
-            const uint32_t TocEntryIndex = GetFileData(File);
-            std::string FilePath;
+    bool IterateDirectoryIndex(FIoDirectoryIndexHandle DirectoryIndexHandle, const std::string& Path, const FDirectoryIndexVisitorFunction& Visit) const {
+        return IterateFiles(DirectoryIndexHandle, Path, [&Visit](const FIoDirectoryIndexFile& File) {
+            return Visit(std::string(File.Path), File.TocEntryIndex);
+        });
+    }
+
+    // Walks the tree depth first with an explicit stack. Every level remembers the next sibling to visit and where
+    // its name starts in the shared path buffer, so entering a directory only appends its name to the buffer.
+    bool IterateFiles(FIoDirectoryIndexHandle DirectoryIndexHandle, std::string_view PathPrefix, const FDirectoryIndexFileVisitorFunction& Visit) const {
+        if (!DirectoryIndexHandle.IsValid() || !IsValidIndex()) {
+            return true;
+        }
+
+        struct FDirectoryLevel {
+            FIoDirectoryIndexHandle NextDirectory;
+            size_t PathLength;
+        };
+
+        std::string Path;
+        Path.reserve(512);
+        Path.append(GetNameView(DirectoryIndex.MountPoint));
+        Path.append(PathPrefix);
+
+        if (!VisitFiles(DirectoryIndexHandle, Path, Visit)) {
+            return false;
+        }
 
-            std::string MountPoint = GetMountPoint();
-            std::string FileName = GetFileName(File);
+        std::vector<FDirectoryLevel> Stack;
+        Stack.push_back({ GetChildDirectory(DirectoryIndexHandle), Path.size() });
+        while (!Stack.empty()) {
+            FDirectoryLevel& Level = Stack.back();
+            if (!Level.NextDirectory.IsValid()) {
+                Stack.pop_back();
+                continue;
+            }
 
-            MountPoint.pop_back(); // Get rid of null terminator
-            FileName.pop_back();
+            const FIoDirectoryIndexHandle Directory = Level.NextDirectory;
+            Level.NextDirectory = GetNextDirectory(Directory);
 
-            FilePath.append(MountPoint);
-            FilePath.append(Path);
-            FilePath.append(FileName);
+            Path.resize(Level.PathLength);
+            Path.append(GetNameView(DirectoryIndex.StringTable[GetDirectoryEntry(Directory).Name]));
+            Path.push_back('/');
 
-            if (!Visit(FilePath, TocEntryIndex)) {
+            if (!VisitFiles(Directory, Path, Visit)) {
                 return false;
             }
 
-            File = GetNextFile(File);
+            Stack.push_back({ GetChildDirectory(Directory), Path.size() });
         }
 
-        FIoDirectoryIndexHandle ChildDirectory = GetChildDirectory(DirectoryIndexHandle);
-        while (ChildDirectory.IsValid()) {
-            std::string DirectoryName = GetDirectoryName(ChildDirectory);
-            std::string ChildDirectoryPath;
+        return true;
+    }
+
+    FIoDirectoryIndexHandle FindFile(std::string_view Path) const {
+        if (!IsValidIndex()) {
+            return FIoDirectoryIndexHandle::Invalid();
+        }
 
-            DirectoryName.pop_back();
-            ChildDirectoryPath.append(Path);
-            ChildDirectoryPath.append(DirectoryName);
-            ChildDirectoryPath.append("/");
+        const std::string_view MountPoint = GetNameView(DirectoryIndex.MountPoint);
+        if (EqualsIgnoreCase(Path.substr(0, MountPoint.size()), MountPoint)) {
+            Path.remove_prefix(MountPoint.size());
+        }
 
-            if (!IterateDirectoryIndex(ChildDirectory, ChildDirectoryPath, Visit)) {
-                return false;
+        FIoDirectoryIndexHandle Directory = FIoDirectoryIndexHandle::RootDirectory();
+        while (Directory.IsValid()) {
+            const size_t Separator = Path.find_first_of("/\\");
+            if (Separator == std::string_view::npos) {
+                return FindChild(Directory, Path, true);
             }
 
-            ChildDirectory = GetNextDirectory(ChildDirectory);
+            // Empty components come from leading or doubled separators
+            const std::string_view Name = Path.substr(0, Separator);
+            Path.remove_prefix(Separator + 1);
+            if (!Name.empty()) {
+                Directory = FindChild(Directory, Name, false);
+            }
         }
 
-        return true;
+        return FIoDirectoryIndexHandle::Invalid();
     }
 private:
+    // Child directories and files of one directory keyed by HashName. Only built for directories where a hash
+    // lookup beats walking the sibling lists.
+    struct FChildLookup {
+        phmap::flat_hash_map<uint64_t, uint32_t> Directories;
+        phmap::flat_hash_map<uint64_t, uint32_t> Files;
+    };
+
+    static constexpr uint32_t MinEntriesForChildLookup = 16;
+
+    // Names never contain slashes, so folding them only matters for the mount point
+    static char FoldChar(char Char) {
+        return Char >= 'A' && Char <= 'Z' ? Char + ('a' - 'A') : Char == '\\' ? '/' : Char;
+    }
+
+    static bool EqualsIgnoreCase(std::string_view A, std::string_view B) {
+        return A.size() == B.size() && std::equal(A.begin(), A.end(), B.begin(), [](char L, char R) { return FoldChar(L) == FoldChar(R); });
+    }
+
+    // FNV-1a over the folded name, so it needs no lowercased copy
+    static uint64_t HashName(std::string_view Name) {
+        uint64_t Hash = 0xcbf29ce484222325ull;
+        for (char Char : Name) {
+            Hash = (Hash ^ uint8_t(FoldChar(Char))) * 0x100000001b3ull;
+        }
+        return Hash;
+    }
+
+    FIoDirectoryIndexHandle FindChild(FIoDirectoryIndexHandle Directory, std::string_view Name, bool bFile) const {
+        if (const FChildLookup* Lookup = GetChildLookup(Directory)) {
+            const auto& Children = bFile ? Lookup->Files : Lookup->Directories;
+            auto It = Children.find(HashName(Name));
+            if (It == Children.end()) {
+                return FIoDirectoryIndexHandle::Invalid();
+            }
+
+            const uint32_t NameIndex = bFile ? DirectoryIndex.FileEntries[It->second].Name : DirectoryIndex.DirectoryEntries[It->second].Name;
+            return EqualsIgnoreCase(GetNameView(DirectoryIndex.StringTable[NameIndex]), Name)
+                ? FIoDirectoryIndexHandle::FromIndex(It->second)
+                : FIoDirectoryIndexHandle::Invalid();
+        }
+
+        if (bFile) {
+            for (FIoDirectoryIndexHandle File = GetFile(Directory); File.IsValid(); File = GetNextFile(File)) {
+                if (EqualsIgnoreCase(GetNameView(DirectoryIndex.StringTable[GetFileEntry(File).Name]), Name)) {
+                    return File;
+                }
+            }
+        }
+        else {
+            for (FIoDirectoryIndexHandle Child = GetChildDirectory(Directory); Child.IsValid(); Child = GetNextDirectory(Child)) {
+                if (EqualsIgnoreCase(GetNameView(DirectoryIndex.StringTable[GetDirectoryEntry(Child).Name]), Name)) {
+                    return Child;
+                }
+            }
+        }
+        return FIoDirectoryIndexHandle::Invalid();
+    }
+
+    // Null for directories too small to be worth a table, that answer is remembered as well
+    const FChildLookup* GetChildLookup(FIoDirectoryIndexHandle Directory) const {
+        {
+            std::shared_lock<std::shared_mutex> Lock(ChildLookupsMutex);
+            auto It = ChildLookups.find(Directory.ToIndex());
+            if (It != ChildLookups.end()) {
+                return It->second.get();
+            }
+        }
+
+        TUniquePtr<FChildLookup> Lookup = std::make_unique<FChildLookup>();
+        for (FIoDirectoryIndexHandle File = GetFile(Directory); File.IsValid(); File = GetNextFile(File)) {
+            Lookup->Files.emplace(HashName(GetNameView(DirectoryIndex.StringTable[GetFileEntry(File).Name])), File.ToIndex());
+        }
+        for (FIoDirectoryIndexHandle Child = GetChildDirectory(Directory); Child.IsValid(); Child = GetNextDirectory(Child)) {
+            Lookup->Directories.emplace(HashName(GetNameView(DirectoryIndex.StringTable[GetDirectoryEntry(Child).Name])), Child.ToIndex());
+        }
+        if (Lookup->Files.size() + Lookup->Directories.size() < MinEntriesForChildLookup) {
+            Lookup.reset();
+        }
+
+        // Another thread may have built the same table meanwhile, the first one stays
+        std::unique_lock<std::shared_mutex> Lock(ChildLookupsMutex);
+        return ChildLookups.try_emplace(Directory.ToIndex(), std::move(Lookup)).first->second.get();
+    }
+
     const FIoDirectoryIndexEntry& GetDirectoryEntry(FIoDirectoryIndexHandle Directory) const {
         return DirectoryIndex.DirectoryEntries[Directory.ToIndex()];
     }
@@ -143,13 +273,47 @@ private:
         return DirectoryIndex.DirectoryEntries.size() > 0;
     }
 
+    // Names are serialized with their null terminator, the views leave it out
+    static std::string_view GetNameView(const std::string& Name) {
+        return !Name.empty() && Name.back() == '\0' ? std::string_view(Name.data(), Name.size() - 1) : std::string_view(Name);
+    }
+
+    // Path holds the directory's path on entry and is restored to it before returning
+    bool VisitFiles(FIoDirectoryIndexHandle Directory, std::string& Path, const FDirectoryIndexFileVisitorFunction& Visit) const {
+        const size_t DirectoryLength = Path.size();
+
+        FIoDirectoryIndexFile File;
+
+        for (FIoDirectoryIndexHandle FileHandle = GetFile(Directory); FileHandle.IsValid(); FileHandle = GetNextFile(FileHandle)) {
+            const FIoFileIndexEntry& FileEntry = GetFileEntry(FileHandle);
+            Path.append(GetNameView(DirectoryIndex.StringTable[FileEntry.Name]));
+
+            // Views are made after appending, the append may have moved the buffer
+            File.Path = Path;
+            File.Directory = File.Path.substr(0, DirectoryLength);
+            File.FileName = File.Path.substr(DirectoryLength);
+            File.TocEntryIndex = FileEntry.UserData;
+
+            const bool bContinue = Visit(File);
+            Path.resize(DirectoryLength);
+            if (!bContinue) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     FIoDirectoryIndexResource DirectoryIndex;
+
+    mutable std::shared_mutex ChildLookupsMutex;
+    mutable TMap<uint32_t, TUniquePtr<FChildLookup>> ChildLookups;
 };
 
 FIoDirectoryIndexReader::FIoDirectoryIndexReader() : Impl(new FIoDirectoryIndexReaderImpl) {}
 FIoDirectoryIndexReader::~FIoDirectoryIndexReader() { delete Impl; }
 
-FIoStatus FIoDirectoryIndexReader::Initialize(std::vector<uint8_t>& InBuffer, FAESKey InDecryptionKey) {
+FIoStatus FIoDirectoryIndexReader::Initialize(const std::vector<uint8_t>& InBuffer, FAESKey InDecryptionKey) {
     return Impl->Initialize(InBuffer, InDecryptionKey);
 }
 
@@ -187,4 +351,12 @@ uint32_t FIoDirectoryIndexReader::GetFileData(FIoDirectoryIndexHandle File) cons
 
 bool FIoDirectoryIndexReader::IterateDirectoryIndex(FIoDirectoryIndexHandle Directory, std::string Path, FDirectoryIndexVisitorFunction Visit) const {
     return Impl->IterateDirectoryIndex(Directory, Path, Visit);
+}
+
+FIoDirectoryIndexHandle FIoDirectoryIndexReader::FindFile(std::string_view Path) const {
+    return Impl->FindFile(Path);
+}
+
+bool FIoDirectoryIndexReader::IterateFiles(FIoDirectoryIndexHandle Directory, const FDirectoryIndexFileVisitorFunction& Visit) const {
+    return Impl->IterateFiles(Directory, "", Visit);
 }
\ No newline at end of file
@@ -2,6 +2,7 @@ export module Saturn.IoStore.IoDirectoryIndex;
 
 import <vector>;
 import <string>;
+import <string_view>;
 import <cstdint>;
 import <functional>;
 
@@ -66,11 +67,22 @@ private:
 
 export using FDirectoryIndexVisitorFunction = std::function<bool(std::string, const uint32_t)>;
 
+// A file visited by FIoDirectoryIndexReader::IterateFiles. The views point into the index and into a path
+// buffer that is reused for the next file, so copy whatever has to outlive the visit.
+export struct FIoDirectoryIndexFile {
+    std::string_view Path;      // Mount point, directories and file name
+    std::string_view Directory; // Leading part of Path, up to and including the last '/'
+    std::string_view FileName;
+    uint32_t TocEntryIndex = ~uint32_t(0);
+};
+
+export using FDirectoryIndexFileVisitorFunction = std::function<bool(const FIoDirectoryIndexFile&)>;
+
 export class FIoDirectoryIndexReader {
 public:
     FIoDirectoryIndexReader();
     ~FIoDirectoryIndexReader();
-    FIoStatus Initialize(std::vector<uint8_t>& InBuffer, FAESKey InDecryptionKey);
+    FIoStatus Initialize(const std::vector<uint8_t>& InBuffer, FAESKey InDecryptionKey);
 
     const std::string GetMountPoint() const;
     FIoDirectoryIndexHandle GetChildDirectory(FIoDirectoryIndexHandle Directory) const;
@@ -82,6 +94,14 @@ public:
     uint32_t GetFileData(FIoDirectoryIndexHandle File) const;
 
     bool IterateDirectoryIndex(FIoDirectoryIndexHandle Directory, std::string Path, FDirectoryIndexVisitorFunction Visit) const;
+
+    // Visits every file below Directory in the same order as IterateDirectoryIndex without allocating per file
+    bool IterateFiles(FIoDirectoryIndexHandle Directory, const FDirectoryIndexFileVisitorFunction& Visit) const;
+
+    // Resolves one file by walking the tree a path component at a time, ignoring case. Path may start with the
+    // mount point or be relative to it, either kind of slash separates components. Directories with a lot of entries
+    // get a child hash table the first time a lookup passes through them. Returns an invalid handle if there's no such file.
+    FIoDirectoryIndexHandle FindFile(std::string_view Path) const;
 private:
     class FIoDirectoryIndexReaderImpl* Impl;
 };
\ No newline at end of file
@@ -6,29 +6,42 @@
 import Saturn.IoStore.IoStoreReader;
 
 import Saturn.Compression;
+import Saturn.Compression.Oodle;
 import Saturn.Structs.Guid;
 import Saturn.Misc.IoBuffer;
 import Saturn.Core.IoStatus;
 import Saturn.Encryption.AES;
+import Saturn.Structs.IoHash;
 import Saturn.Structs.IoChunkId;
-import Saturn.Readers.FileReader;
 import Saturn.Misc.IoReadOptions;
 import Saturn.Structs.IoOffsetLength;
 import Saturn.IoStore.IoDirectoryIndex;
 import Saturn.Structs.IoStoreTocHeader;
 import Saturn.Readers.FileReaderNoWrite;
+import Saturn.Readers.PositionalFileReader;
+import Saturn.Readers.ContainerFileMapping;
+import Saturn.Readers.AsyncReadBackend;
 import Saturn.Structs.IoStoreTocResource;
 import Saturn.Structs.IoStoreTocChunkInfo;
-import Saturn.Files.WindowsCriticalSection;
+import Saturn.Core.TaskExecutor;
+import Saturn.IoStore.IoBlockCache;
 import Saturn.Container.IoStoreCompressedReadResult;
 
 import <cstdint>;
 import <atomic>;
 import <future>;
+import <exception>;
 import <string>;
 import <vector>;
+import <mutex>;
 import <optional>;
+import <span>;
+import <string_view>;
+import <algorithm>;
 import <functional>;
+import <thread>;
+import <chrono>;
+import <condition_variable>;
 
 class FIoStoreTocReader {
 public:
@@ -42,37 +55,19 @@ public:
             return TocStatus;
         }
 
-        ChunkIdToIndex.clear();
-        for (int32_t ChunkIndex = 0; ChunkIndex < Toc.ChunkIds.size(); ++ChunkIndex) {
-            ChunkIdToIndex.insert_or_assign(Toc.ChunkIds[ChunkIndex], ChunkIndex);
+        FIoStatus SetupStatus = Setup(TocFilePath, DecryptionKeys);
+        if (!SetupStatus.IsOk()) {
+            return SetupStatus;
         }
 
-        if (EnumHasAnyFlags(Toc.Header.ContainerFlags, EIoContainerFlags::Encrypted)) {
-            auto It = DecryptionKeys.find(Toc.Header.EncryptionKeyGuid);
-            const FAESKey* FindKey = (It != DecryptionKeys.end()) ? &It->second : nullptr;
-            if (!FindKey) {
-                return FIoStatusBuilder(EIoErrorCode::FileOpenFailed) << "Missing decryption key for IoStore container file '" << TocFilePath << "'";
-            }
-            DecryptionKey = *FindKey;
-        }
-
-        if (EnumHasAnyFlags(Toc.Header.ContainerFlags, EIoContainerFlags::Indexed) &&
-            Toc.DirectoryIndexBuffer.size() > 0) {
-                FIoStatus DirectoryIndexStatus = DirectoryIndexReader.Initialize(Toc.DirectoryIndexBuffer, DecryptionKey);
-                if (!DirectoryIndexStatus.IsOk()) {
-                    return DirectoryIndexStatus;
-                }
-                DirectoryIndexReader.IterateDirectoryIndex(
-                    FIoDirectoryIndexHandle::RootDirectory(),
-                    "",
-                    [this](std::string Filename, uint32_t TocEntryIndex) -> bool
-                    {
-                        AddFileName(TocEntryIndex, Filename);
-                        return true;
-                    });
-        }
+        return LoadDirectoryIndex();
+    }
 
-        return TocStatus;
+    // Takes over a TOC that was already parsed, e.g. restored from a mount snapshot. The directory
+    // index is only decrypted and parsed once something asks for it.
+    [[nodiscard]] FIoStatus Load(const std::string& TocFilePath, FIoStoreTocResource&& InToc, const TMap<FGuid, FAESKey>& DecryptionKeys) {
+        Toc = std::move(InToc);
+        return Setup(TocFilePath, DecryptionKeys);
     }
 
     FIoStoreTocResource& GetTocResource() {
@@ -88,19 +83,55 @@ public:
     }
 
     const FIoDirectoryIndexReader& GetDirectoryIndexReader() const {
+        (void)LoadDirectoryIndex();
         return DirectoryIndexReader;
     }
 
-    const int32_t* GetTocEntryIndex(const FIoChunkId& ChunkId) const {
-        auto it = ChunkIdToIndex.find(ChunkId);
-        if (it != ChunkIdToIndex.end()) {
-            return &it->second;
+    std::optional<int32_t> GetTocEntryIndex(const FIoChunkId& ChunkId) const {
+        if (!ChunkIdToIndex.empty()) {
+            auto It = ChunkIdToIndex.find(ChunkId);
+            if (It != ChunkIdToIndex.end()) {
+                return It->second;
+            }
         }
-        return nullptr;
+
+        if (Toc.ChunkPerfectHashSeeds.empty()) {
+            return std::nullopt;
+        }
+
+        const uint32_t ChunkCount = static_cast<uint32_t>(Toc.ChunkIds.size());
+        const uint32_t SeedCount = static_cast<uint32_t>(Toc.ChunkPerfectHashSeeds.size());
+        if (ChunkCount == 0) {
+            return std::nullopt;
+        }
+
+        const uint32_t SeedIndex = static_cast<uint32_t>(FIoStoreTocResource::HashChunkIdWithSeed(0, ChunkId) % SeedCount);
+        const int32_t Seed = Toc.ChunkPerfectHashSeeds[SeedIndex];
+        if (Seed == 0) {
+            return std::nullopt;
+        }
+
+        uint32_t Slot;
+        if (Seed < 0) {
+            // Negative seeds store the index of a chunk that was alone in its bucket
+            const uint32_t SeedAsIndex = static_cast<uint32_t>(-Seed - 1);
+            if (SeedAsIndex >= ChunkCount) {
+                return std::nullopt;
+            }
+            Slot = SeedAsIndex;
+        }
+        else {
+            Slot = static_cast<uint32_t>(FIoStoreTocResource::HashChunkIdWithSeed(Seed, ChunkId) % ChunkCount);
+        }
+
+        if (Toc.ChunkIds[Slot] == ChunkId) {
+            return static_cast<int32_t>(Slot);
+        }
+        return std::nullopt;
     }
 
     const FIoOffsetAndLength* GetOffsetAndLength(const FIoChunkId& ChunkId) const {
-        if (const int32_t* Index = GetTocEntryIndex(ChunkId)) {
+        if (std::optional<int32_t> Index = GetTocEntryIndex(ChunkId)) {
             return &Toc.ChunkOffsetAndLengths[*Index];
         }
         return nullptr;
@@ -109,6 +140,20 @@ public:
     FIoStoreTocChunkInfo GetTocChunkInfo(int32_t TocEntryIndex) const {
         FIoStoreTocChunkInfo ChunkInfo = Toc.GetTocChunkInfo(TocEntryIndex);
 
+        std::call_once(FileNamesLoaded, [this]() {
+            if (!LoadDirectoryIndex().IsOk()) {
+                return;
+            }
+
+            DirectoryIndexReader.IterateFiles(
+                FIoDirectoryIndexHandle::RootDirectory(),
+                [this](const FIoDirectoryIndexFile& File) -> bool
+                {
+                    AddFileName(File.TocEntryIndex, std::string(File.Path));
+                    return true;
+                });
+        });
+
         auto It = IndexToFileName.find(TocEntryIndex);
         if (const std::string* FileName = ((It != IndexToFileName.end()) ? &It->second : nullptr); FileName != nullptr) {
             ChunkInfo.FileName = *FileName;
@@ -121,88 +166,163 @@ public:
         return ChunkInfo;
     }
 private:
-    void AddFileName(int32_t TocEntryIndex, std::string Filename) {
-        IndexToFileName.insert({ TocEntryIndex, Filename });
+    FIoStatus Setup(const std::string& TocFilePath, const TMap<FGuid, FAESKey>& DecryptionKeys) {
+        // Chunks are resolved through the TOC's perfect hash, the map only holds the chunks the
+        // perfect hash doesn't cover. Containers written without seeds fall back to a full map.
+        ChunkIdToIndex.clear();
+        if (!Toc.ChunkPerfectHashSeeds.empty()) {
+            for (int32_t ChunkIndex : Toc.ChunkIndicesWithoutPerfectHash) {
+                ChunkIdToIndex.insert_or_assign(Toc.ChunkIds[ChunkIndex], ChunkIndex);
+            }
+        }
+        else {
+            for (int32_t ChunkIndex = 0; ChunkIndex < Toc.ChunkIds.size(); ++ChunkIndex) {
+                ChunkIdToIndex.insert_or_assign(Toc.ChunkIds[ChunkIndex], ChunkIndex);
+            }
+        }
+
+        if (EnumHasAnyFlags(Toc.Header.ContainerFlags, EIoContainerFlags::Encrypted)) {
+            auto It = DecryptionKeys.find(Toc.Header.EncryptionKeyGuid);
+            const FAESKey* FindKey = (It != DecryptionKeys.end()) ? &It->second : nullptr;
+            if (!FindKey) {
+                return FIoStatusBuilder(EIoErrorCode::FileOpenFailed) << "Missing decryption key for IoStore container file '" << TocFilePath << "'";
+            }
+            DecryptionKey = *FindKey;
+        }
+
+        return FIoStatus::Ok;
+    }
+
+    // Parses the directory index on first use, later calls return the status of the first one
+    FIoStatus LoadDirectoryIndex() const {
+        std::call_once(DirectoryIndexLoaded, [this]() {
+            if (EnumHasAnyFlags(Toc.Header.ContainerFlags, EIoContainerFlags::Indexed) &&
+                Toc.DirectoryIndexBuffer.size() > 0) {
+                    DirectoryIndexStatus = DirectoryIndexReader.Initialize(Toc.DirectoryIndexBuffer, DecryptionKey);
+            }
+        });
+
+        return DirectoryIndexStatus;
+    }
+
+    void AddFileName(int32_t TocEntryIndex, std::string&& Filename) const {
+        IndexToFileName.insert({ TocEntryIndex, std::move(Filename) });
     }
 
     FIoStoreTocResource Toc;
-    FIoDirectoryIndexReader DirectoryIndexReader;
     FAESKey DecryptionKey;
     TMap<FIoChunkId, int32_t> ChunkIdToIndex;
-    TMap<int32_t, std::string> IndexToFileName;
+
+    mutable std::once_flag DirectoryIndexLoaded;
+    mutable FIoStatus DirectoryIndexStatus = FIoStatus::Ok;
+    mutable FIoDirectoryIndexReader DirectoryIndexReader;
+
+    mutable std::once_flag FileNamesLoaded;
+    mutable TMap<int32_t, std::string> IndexToFileName;
 };
 
 class FIoStoreReaderImpl {
 public:
 	FIoStoreReaderImpl() {}
 
-	//
-	// FileReader isn't designed around a lot of jobs throwing accesses at it, so instead we
-	// use it directly and round robin between a number of file haandles in order to saturate
-	// year 2022 ssd drives. For a file hot in the windows file cache, you can get 4+ GB/s with as few as
-	// 4 file handles, however for a cold file you need upwards of 32 in order to reach ~1.5 GB/s. This is
-	// low because IoStoreReader (note: not IoDispatcher!) reads are comparatively small - at most you're reading compression block sized
-	// chunks when uncompressed, however with Oodle those get cut by ~half, so with a default block size
-	// of 64kb, reads are generally less than 32kb, which is tough to use and get full ssd bandwith out of.
-	//
-	static constexpr uint32_t NumHandlesPerFile = 12;
-	struct FContainerFileAccess {
-		FCriticalSection HandleLock[NumHandlesPerFile];
-		FFileReader* Handle[NumHandlesPerFile];
-		std::atomic_uint32_t NextHandleIndex{ 0 };
-		bool bValid = false;
-
-		FContainerFileAccess(std::string& ContainerFileName) {
-			bValid = true;
-			for (uint32_t i = 0; i < NumHandlesPerFile; i++) {
-				Handle[i] = new FFileReader(ContainerFileName.c_str());
-				if (Handle[i] == nullptr) {
-					bValid = false;
-				}
-			}
-		}
-
-		~FContainerFileAccess() {
-			for (int32_t Index = 0; Index < NumHandlesPerFile; Index++) {
-				if (Handle[Index] != nullptr) {
-					Handle[Index]->Close();
-					delete Handle[Index];
-					Handle[Index] = nullptr;
-				}
-			}
-		}
-
-		bool IsValid() const { return bValid; }
-	};
-
-    // Kick off an async read from the iostore container, rotating between the file handles for the partition
-    std::future<void> StartAsyncRead(int32_t InPartitionIndex, int64_t InPartitionOffset, int64_t InReadAmount, uint8_t* OutBuffer, std::atomic_bool* OutSuccess) const {
-        return std::async(std::launch::async, [this, InPartitionIndex, InPartitionOffset, OutBuffer, InReadAmount, OutSuccess]() mutable {
-            FContainerFileAccess* ContainerFileAccess = this->ContainerFileAccessors[InPartitionIndex].get();
-
-            // Round robin between the file handles. Since we are alwaays reading blocks, everything is ~roughly~ the same
-            // size so we don't have to worry about a single huge read backing up one handle.
-            uint32_t OurIndex = ContainerFileAccess->NextHandleIndex.fetch_add(1);
-            OurIndex %= NumHandlesPerFile;
-
-            // Each file handle can only be touched by one task at a time. We use an OS lock so that the OS scheduler
-            // knows we're in a wait state and who we're waiting on.
-            // 
-            // CAUTION if any overload of FileReader launches tasks (... unlikely ...) this could deadlock if NumHandlesPerFile is more
-            // than the number of worker threads, as the OS lock will not do task retraction.
-            {
-                ContainerFileAccess->HandleLock[OurIndex].Lock();
+    //
+    // Every partition is opened once and read with positional reads, which carry their own offset. Any number
+    // of tasks can read from the same handle at the same time, so a slow read never holds up an unrelated one
+    // and there is no lock on the read path. Reads are generally compression block sized or smaller, so
+    // throughput on cold files comes from having many of them in flight, which the executor already provides.
+    //
+    // Reads are served from the partition's shared read-only mapping when it covers them. Blocks appended
+    // after the partition was mapped, or reads while the mapping is released for a trim, use the handle.
+    //
+    struct FContainerFileAccess {
+        FPositionalFileReader File;
+        TSharedPtr<FContainerFileMapping> Mapping;
+
+        FContainerFileAccess(const std::string& ContainerFileName) : File(ContainerFileName.c_str()), Mapping(FContainerFileMapping::Get(ContainerFileName)) {}
+
+        bool IsValid() const { return File.IsValid(); }
+    };
+
+    // Blocking read from the iostore container, safe to call from any number of threads
+    bool ReadContainerRange(int32_t InPartitionIndex, int64_t InPartitionOffset, int64_t InReadAmount, uint8_t* OutBuffer) const {
+        const FContainerFileAccess& ContainerFileAccess = *ContainerFileAccessors[InPartitionIndex];
+        if (ContainerFileAccess.Mapping && ContainerFileAccess.Mapping->ReadAt(OutBuffer, InReadAmount, InPartitionOffset)) {
+            return true;
+        }
+        return ContainerFileAccess.File.ReadAt(OutBuffer, InReadAmount, InPartitionOffset);
+    }
+
+    // Queue a read on the async read backend, Callback runs on whichever thread completes it
+    void ReadContainerRangeAsync(int32_t InPartitionIndex, int64_t InPartitionOffset, int64_t InReadAmount, uint8_t* OutBuffer, FAsyncReadBackend::FReadCallback&& Callback) const {
+        const FContainerFileAccess& ContainerFileAccess = *ContainerFileAccessors[InPartitionIndex];
+
+        FAsyncReadRequest Request;
+        Request.File = &ContainerFileAccess.File;
+        Request.Mapping = ContainerFileAccess.Mapping.get();
+        Request.Destination = OutBuffer;
+        Request.Length = InReadAmount;
+        Request.Offset = InPartitionOffset;
+        FAsyncReadBackend::Get().Read(Request, std::move(Callback));
+    }
+
+    // Kick off an async read and get a handle to wait on
+    FTaskHandle StartAsyncRead(int32_t InPartitionIndex, int64_t InPartitionOffset, int64_t InReadAmount, uint8_t* OutBuffer, std::atomic_bool* OutSuccess) const {
+        FTaskHandle ReadHandle = FTaskExecutor::MakePendingHandle();
+        ReadContainerRangeAsync(InPartitionIndex, InPartitionOffset, InReadAmount, OutBuffer, [OutSuccess, ReadHandle](bool bSucceeded) {
+            OutSuccess->store(bSucceeded);
+            FTaskExecutor::Complete(ReadHandle);
+        });
+        return ReadHandle;
+    }
+
+    FIoBlockKey MakeBlockKey(int32_t BlockIndex) const {
+        return FIoBlockKey { TocReader.GetTocResource().Header.ContainerId.Value(), BlockIndex };
+    }
+
+    // Taken before going to disk, so blocks read before the container got invalidated never make it into the cache
+    uint64_t GetCacheGeneration() const {
+        return FIoBlockCache::Get().GetGeneration(TocReader.GetTocResource().Header.ContainerId.Value());
+    }
+
+    // Decrypts and decompresses one block as read from disk, then copies [OffsetInBlock, OffsetInBlock + CopySize)
+    // of it to Destination. The full decoded block is offered to the block cache on the way out unless bOfferToCache is false,
+    // CacheGeneration is what GetCacheGeneration returned before the block was read.
+    bool DecodeBlock(int32_t BlockIndex, uint8_t* CompressedSource, uint8_t* Destination, uint64_t OffsetInBlock, uint64_t CopySize, std::vector<uint8_t>& TempBuffer, uint64_t CacheGeneration, bool bOfferToCache = true) const {
+        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+        const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndex];
+        const uint32_t RawSize = Align(CompressionBlock.GetCompressedSize(), FAESKey::AESBlockSize);
+        const uint32_t UncompressedSize = CompressionBlock.GetUncompressedSize();
+        const uint8_t CompressionMethodIndex = CompressionBlock.GetCompressionMethodIndex();
+
+        if (EnumHasAnyFlags(TocResource.Header.ContainerFlags, EIoContainerFlags::Encrypted)) {
+            TocReader.GetDecryptionKey().DecryptData(CompressedSource, RawSize);
+        }
+
+        const uint8_t* DecodedBlock = CompressedSource;
+        if (CompressionMethods[CompressionMethodIndex] != ECompressionMethod::None) {
+            // If this block is larger than the amount of data actually requested, decompress to a temp
+            // buffer and then copy out. Should never happen when reading the entire chunk.
+            uint8_t* DecompressTarget = Destination;
+            if (OffsetInBlock || CopySize < UncompressedSize) {
+                TempBuffer.resize(UncompressedSize);
+                DecompressTarget = TempBuffer.data();
             }
 
-            bool bReadSucceeded;
-            {
-                ContainerFileAccess->Handle[OurIndex]->Seek(InPartitionOffset);
-                bReadSucceeded = ContainerFileAccess->Handle[OurIndex]->Serialize(OutBuffer, InReadAmount);
+            FDecompressionFunc Decompress = Decompressors[CompressionMethodIndex];
+            if (!Decompress || !Decompress(DecompressTarget, UncompressedSize, CompressedSource, CompressionBlock.GetCompressedSize())) {
+                return false;
             }
+            DecodedBlock = DecompressTarget;
+        }
 
-            OutSuccess->store(bReadSucceeded);
-            ContainerFileAccess->HandleLock[OurIndex].Unlock();
-        });
+        if (DecodedBlock != Destination) {
+            memcpy(Destination, DecodedBlock + OffsetInBlock, CopySize);
+        }
+
+        if (bOfferToCache) {
+            FIoBlockCache::Get().Insert(MakeBlockKey(BlockIndex), DecodedBlock, UncompressedSize, CacheGeneration);
+        }
+        return true;
     }
 
     [[nodiscard]] FIoStatus Initialize(const std::string& InContainerPath, const TMap<FGuid, FAESKey>& InDecryptionKeys) {
@@ -217,25 +337,22 @@ public:
             return TocStatus;
         }
 
-        FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+        return OpenContainer(TocFilePath);
+    }
 
-        ContainerFileAccessors.reserve(TocResource.Header.PartitionCount);
-        for (uint32_t PartitionIndex = 0; PartitionIndex < TocResource.Header.PartitionCount; ++PartitionIndex) {
-            std::string ContainerFilePath;
-            ContainerFilePath.append(InContainerPath);
-            if (PartitionIndex > 0) {
-                ContainerFilePath.append("_s");
-                ContainerFilePath.append(std::to_string(PartitionIndex));
-            }
-            ContainerFilePath.append(".ucas");
+    [[nodiscard]] FIoStatus Initialize(const std::string& InContainerPath, FIoStoreTocResource&& InTocResource, const TMap<FGuid, FAESKey>& InDecryptionKeys) {
+        ContainerPath = InContainerPath;
 
-            ContainerFileAccessors.emplace_back(std::unique_ptr<FContainerFileAccess>(new FContainerFileAccess(ContainerFilePath)));
-            if (ContainerFileAccessors[PartitionIndex]->IsValid() == false) {
-                return FIoStatusBuilder(EIoErrorCode::FileOpenFailed) << "Failed to open IoStore container file '" << TocFilePath << "'";
-            }
+        std::string TocFilePath;
+        TocFilePath.append(InContainerPath);
+        TocFilePath.append(".utoc");
+
+        FIoStatus TocStatus = TocReader.Load(TocFilePath, std::move(InTocResource), InDecryptionKeys);
+        if (!TocStatus.IsOk()) {
+            return TocStatus;
         }
 
-        return FIoStatus::Ok;
+        return OpenContainer(TocFilePath);
     }
 
     FIoContainerId GetContainerId() const {
@@ -274,7 +391,7 @@ public:
     }
 
     TIoStatusOr<FIoStoreTocChunkInfo> GetChunkInfo(const FIoChunkId& ChunkId) const {
-        const int32_t* TocEntryIndex = TocReader.GetTocEntryIndex(ChunkId);
+        std::optional<int32_t> TocEntryIndex = TocReader.GetTocEntryIndex(ChunkId);
         if (TocEntryIndex) {
             return TocReader.GetTocChunkInfo(*TocEntryIndex);
         }
@@ -302,6 +419,9 @@ public:
             std::optional<FIoBuffer> UncompressedBuffer;
             std::atomic_bool bReadSucceeded { false };
             std::atomic_bool bUncompressFailed { false };
+            std::atomic_int32_t RemainingBlocks { 0 };
+            std::vector<FIoBlockCache::FBlockRef> CachedBlocks;
+            std::promise<TIoStatusOr<FIoBuffer>> Promise;
         };
 
         const FIoOffsetAndLength* OffsetAndLength = TocReader.GetOffsetAndLength(ChunkId);
@@ -336,95 +456,205 @@ public:
         FState* State = new FState();
         State->CompressedSize = ReadEndOffset - ReadStartOffset;
         State->UncompressedSize = ResolvedSize;
-        State->CompressedBuffer.resize(State->CompressedSize);
         State->UncompressedBuffer.emplace(State->UncompressedSize);
 
-        std::future<void> ReadJob = StartAsyncRead(PartitionIndex, ReadStartOffset, (int32_t)State->CompressedSize, State->CompressedBuffer.data(), &State->bReadSucceeded);
+        State->RemainingBlocks = BlockCount;
+        std::future<TIoStatusOr<FIoBuffer>> ReturnTask = State->Promise.get_future();
+        const uint64_t CacheGeneration = GetCacheGeneration();
+
+        // Runs on whichever task finishes last, no task ever blocks waiting on another
+        auto FinishRead = [](FState* State) {
+            TIoStatusOr<FIoBuffer> Result;
+            if (State->bReadSucceeded == false) {
+                Result = FIoStatus(EIoErrorCode::ReadError, "Failed reading chunk from container file");
+            }
+            else if (State->bUncompressFailed) {
+                Result = FIoStatus(EIoErrorCode::ReadError, "Failed uncompressing chunk");
+            }
+            else {
+                Result = State->UncompressedBuffer.value();
+            }
+            State->Promise.set_value(std::move(Result));
+            delete State;
+        };
+
+        // Fans the blocks out to decode tasks once the compressed range is in memory
+        auto DecodeBlocks = [this, State, FinishRead, CacheGeneration, CompressionBlockSize, ResolvedOffset, FirstBlockIndex, LastBlockIndex, ResolvedSize, &TocResource]() {
+            if (!State->bReadSucceeded) {
+                FinishRead(State);
+                return;
+            }
 
-        std::future<TIoStatusOr<FIoBuffer>> ReturnTask = std::async(std::launch::async, [this, State, PartitionIndex, CompressionBlockSize, ResolvedOffset, FirstBlockIndex, LastBlockIndex, ResolvedSize, ReadStartOffset, &TocResource, ReadJob = std::move(ReadJob)]() {
-            ReadJob.wait();
+            // Blocks that never made it into a task still have to be counted down if an Enqueue throws, or the
+            // promise is never set
+            struct FCountDownOnExit {
+                FState* State;
+                const decltype(FinishRead)& Finish;
+                int32_t NotEnqueued;
+                ~FCountDownOnExit() {
+                    if (NotEnqueued > 0) {
+                        State->bUncompressFailed = true;
+                        if (State->RemainingBlocks.fetch_sub(NotEnqueued) == NotEnqueued) {
+                            Finish(State);
+                        }
+                    }
+                }
+            } CountDownOnExit { State, FinishRead, LastBlockIndex - FirstBlockIndex + 1 };
 
             uint64_t CompressedSourceOffset = 0;
             uint64_t UncompressedDestinationOffset = 0;
             uint64_t OffsetInBlock = ResolvedOffset % CompressionBlockSize;
             uint64_t RemainingSize = ResolvedSize;
 
-            std::vector<std::future<void>> DecompressionTasks;
-
             for (int32_t BlockIndex = FirstBlockIndex; BlockIndex <= LastBlockIndex; ++BlockIndex) {
-                DecompressionTasks.emplace_back(std::async(std::launch::async, [this, State, BlockIndex, CompressedSourceOffset, UncompressedDestinationOffset, OffsetInBlock, RemainingSize]() {
-                    if (State->bReadSucceeded) {
-                        uint8_t* CompressedSource = State->CompressedBuffer.data() + CompressedSourceOffset;
-                        uint8_t* UncompressedDestination = State->UncompressedBuffer->Data() + UncompressedDestinationOffset;
-                        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
-                        const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndex];
-                        const uint32_t RawSize = Align(CompressionBlock.GetCompressedSize(), FAESKey::AESBlockSize);
-                        const uint32_t UncompressedSize = CompressionBlock.GetUncompressedSize();
-                        std::string CompressionMethod = TocResource.CompressionMethods[CompressionBlock.GetCompressionMethodIndex()];
-                        if (EnumHasAnyFlags(TocResource.Header.ContainerFlags, EIoContainerFlags::Encrypted)) {
-                            TocReader.GetDecryptionKey().DecryptData(CompressedSource, RawSize);
-                        }
-                        if (CompressionMethod.contains("None")) {
-                            memcpy(UncompressedDestination, CompressedSource + OffsetInBlock, UncompressedSize - OffsetInBlock);
-                        }
-                        else {
-                            bool bUncompressed;
-                            if (OffsetInBlock || RemainingSize < UncompressedSize) {
-                                std::vector<uint8_t> TempBuffer;
-                                TempBuffer.resize(UncompressedSize);
-                                FCompression::DecompressMemory(CompressionMethod, TempBuffer.data(), UncompressedSize, CompressedSource, CompressionBlock.GetCompressedSize());
-                                bUncompressed = std::any_of(TempBuffer.begin(), TempBuffer.end(), [](uint8_t byte) { return byte != 0; });
-                                uint64_t CopySize = std::min(static_cast<uint64_t>(UncompressedSize) - OffsetInBlock, RemainingSize);
-                                memcpy(UncompressedDestination, TempBuffer.data() + OffsetInBlock, CopySize);
-                            }
-                            else {
-                                FCompression::DecompressMemory(CompressionMethod, UncompressedDestination, UncompressedSize, CompressedSource, CompressionBlock.GetCompressedSize());
-                                bUncompressed = std::any_of(UncompressedDestination, UncompressedDestination + UncompressedSize, [](uint8_t byte) { return byte != 0; });
-                            }
-
-                            if (!bUncompressed) {
+                const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndex];
+                const uint64_t CopySize = std::min(static_cast<uint64_t>(CompressionBlock.GetUncompressedSize()) - OffsetInBlock, RemainingSize);
+
+                FTaskExecutor::Get().Enqueue([this, State, FinishRead, CacheGeneration, BlockIndex, FirstBlockIndex, CompressedSourceOffset, UncompressedDestinationOffset, OffsetInBlock, CopySize]() {
+                    // The executor swallows exceptions, so a block that throws still has to count down or the
+                    // promise is never set. It fails the read unless the decode got to the end.
+                    struct FFinishOnExit {
+                        FState* State;
+                        const decltype(FinishRead)& Finish;
+                        bool bDone = false;
+                        ~FFinishOnExit() {
+                            if (!bDone) {
                                 State->bUncompressFailed = true;
                             }
+                            if (State->RemainingBlocks.fetch_sub(1) == 1) {
+                                Finish(State);
+                            }
+                        }
+                    } FinishOnExit { State, FinishRead };
+
+                    uint8_t* UncompressedDestination = State->UncompressedBuffer->Data() + UncompressedDestinationOffset;
+                    if (const FIoBlockCache::FBlockRef& CachedBlock = State->CachedBlocks[BlockIndex - FirstBlockIndex]) {
+                        memcpy(UncompressedDestination, CachedBlock->data() + OffsetInBlock, CopySize);
+                    }
+                    else {
+                        std::vector<uint8_t> TempBuffer;
+                        if (!DecodeBlock(BlockIndex, State->CompressedBuffer.data() + CompressedSourceOffset, UncompressedDestination, OffsetInBlock, CopySize, TempBuffer, CacheGeneration)) {
+                            State->bUncompressFailed = true;
                         }
-                    } // end if read succeeded
-                })); // end decompression lambda
+                    }
+                    FinishOnExit.bDone = true;
+                }); // end decompression task
+                CountDownOnExit.NotEnqueued--;
 
-                const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndex];
-                const uint32_t RawSize = Align(CompressionBlock.GetCompressedSize(), FAESKey::AESBlockSize);
-                CompressedSourceOffset += RawSize;
-                UncompressedDestinationOffset += CompressionBlock.GetUncompressedSize();
-                RemainingSize -= CompressionBlock.GetUncompressedSize();
+                CompressedSourceOffset += Align(CompressionBlock.GetCompressedSize(), FAESKey::AESBlockSize);
+                UncompressedDestinationOffset += CopySize;
+                RemainingSize -= CopySize;
                 OffsetInBlock = 0;
             } // end for each block
+        };
 
-            for (auto& Task : DecompressionTasks) {
-                Task.get();
-            }
+        FTaskExecutor::Get().Enqueue([this, State, FinishRead, DecodeBlocks, PartitionIndex, FirstBlockIndex, LastBlockIndex, ReadStartOffset]() {
+            // Until DecodeBlocks owns the state, a throw here has to fail the read itself
+            struct FFailOnExit {
+                FState* State;
+                const decltype(FinishRead)& Finish;
+                bool bHandedOff = false;
+                ~FFailOnExit() {
+                    if (!bHandedOff) {
+                        State->bReadSucceeded = false;
+                        Finish(State);
+                    }
+                }
+            } FailOnExit { State, FinishRead };
 
-            TIoStatusOr<FIoBuffer> Result;
-            if (State->bReadSucceeded == false) {
-                Result = FIoStatus(EIoErrorCode::ReadError, "Failed reading chunk from container file");
-            }
-            else if (State->bUncompressFailed) {
-                Result = FIoStatus(EIoErrorCode::ReadError, "Failed uncompressing chunk");
+            // Only go to disk if at least one block isn't cached already
+            bool bNeedsRead = false;
+            State->CachedBlocks.resize(LastBlockIndex - FirstBlockIndex + 1);
+            for (int32_t BlockIndex = FirstBlockIndex; BlockIndex <= LastBlockIndex; ++BlockIndex) {
+                State->CachedBlocks[BlockIndex - FirstBlockIndex] = FIoBlockCache::Get().Find(MakeBlockKey(BlockIndex));
+                bNeedsRead |= !State->CachedBlocks[BlockIndex - FirstBlockIndex];
             }
-            else {
-                Result = State->UncompressedBuffer.value();
+
+            if (!bNeedsRead) {
+                State->bReadSucceeded = true;
+                FailOnExit.bHandedOff = true;
+                DecodeBlocks();
+                return;
             }
-            delete State;
 
-            return Result;
+            // Backends only throw before they take the callback, so a throw means it will never run
+            State->CompressedBuffer.resize(State->CompressedSize);
+            ReadContainerRangeAsync(PartitionIndex, ReadStartOffset, State->CompressedSize, State->CompressedBuffer.data(), [State, DecodeBlocks](bool bSucceeded) {
+                State->bReadSucceeded = bSucceeded;
+                DecodeBlocks();
+            });
+            FailOnExit.bHandedOff = true;
         });
 
         return ReturnTask;
     }
 
+    // Blocks stored as is in an unencrypted container need no decoding, their bytes on disk are the chunk's bytes
+    bool IsRawBlock(const FIoStoreTocCompressedBlockEntry& CompressionBlock) const {
+        return !EnumHasAnyFlags(TocReader.GetTocResource().Header.ContainerFlags, EIoContainerFlags::Encrypted)
+            && CompressionMethods[CompressionBlock.GetCompressionMethodIndex()] == ECompressionMethod::None;
+    }
+
+    // One fully decoded block, shared with the block cache. Returns null if it couldn't be read or decoded.
+    FIoBlockCache::FBlockRef ReadBlock(int32_t BlockIndex) const {
+        const FIoBlockKey BlockKey = MakeBlockKey(BlockIndex);
+        if (FIoBlockCache::FBlockRef CachedBlock = FIoBlockCache::Get().Find(BlockKey)) {
+            return CachedBlock;
+        }
+        const uint64_t CacheGeneration = GetCacheGeneration();
+
+        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+        const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndex];
+        const int32_t PartitionIndex = int32_t(CompressionBlock.GetOffset() / TocResource.Header.PartitionSize);
+        const int64_t PartitionOffset = int64_t(CompressionBlock.GetOffset() % TocResource.Header.PartitionSize);
+        const uint32_t UncompressedSize = CompressionBlock.GetUncompressedSize();
+
+        std::shared_ptr<std::vector<uint8_t>> Block = std::make_shared<std::vector<uint8_t>>(UncompressedSize);
+        if (IsRawBlock(CompressionBlock)) {
+            if (!ReadContainerRange(PartitionIndex, PartitionOffset, UncompressedSize, Block->data())) {
+                return nullptr;
+            }
+        }
+        else {
+            std::vector<uint8_t> CompressedBuffer(Align(CompressionBlock.GetCompressedSize(), FAESKey::AESBlockSize));
+            std::vector<uint8_t> TempBuffer;
+            if (!ReadContainerRange(PartitionIndex, PartitionOffset, CompressedBuffer.size(), CompressedBuffer.data())
+                || !DecodeBlock(BlockIndex, CompressedBuffer.data(), Block->data(), 0, UncompressedSize, TempBuffer, CacheGeneration, false)) {
+                return nullptr;
+            }
+        }
+
+        FIoBlockCache::Get().Insert(BlockKey, Block, CacheGeneration);
+        return Block;
+    }
+
     TIoStatusOr<FIoBuffer> Read(const FIoChunkId& ChunkId, const FIoReadOptions& Options) const {
         const FIoOffsetAndLength* OffsetAndLength = TocReader.GetOffsetAndLength(ChunkId);
         if (!OffsetAndLength) {
             return FIoStatus(EIoErrorCode::NotFound, "Unknown chunk ID");
         }
 
+        uint64_t RequestedOffset = Options.GetOffset();
+        uint64_t ResolvedSize = 0;
+        if (RequestedOffset <= OffsetAndLength->GetLength()) {
+            ResolvedSize = std::min(Options.GetSize(), OffsetAndLength->GetLength() - RequestedOffset);
+        }
+
+        FIoBuffer UncompressedBuffer(ResolvedSize);
+        TIoStatusOr<uint64_t> ReadStatus = Read(ChunkId, Options, std::span<uint8_t>(UncompressedBuffer.Data(), ResolvedSize));
+        if (!ReadStatus.IsOk()) {
+            return ReadStatus.Status();
+        }
+        return UncompressedBuffer;
+    }
+
+    // Without the block cache every block comes from disk and decoded blocks aren't offered to the cache
+    TIoStatusOr<uint64_t> Read(const FIoChunkId& ChunkId, const FIoReadOptions& Options, std::span<uint8_t> Destination, bool bUseBlockCache = true) const {
+        const FIoOffsetAndLength* OffsetAndLength = TocReader.GetOffsetAndLength(ChunkId);
+        if (!OffsetAndLength) {
+            return FIoStatus(EIoErrorCode::NotFound, "Unknown chunk ID");
+        }
+
         uint64_t RequestedOffset = Options.GetOffset();
         uint64_t ResolvedOffset = OffsetAndLength->GetOffset() + RequestedOffset;
         uint64_t ResolvedSize = 0;
@@ -432,11 +662,14 @@ public:
             ResolvedSize = std::min(Options.GetSize(), OffsetAndLength->GetLength() - RequestedOffset);
         }
 
+        if (Destination.size() < ResolvedSize) {
+            return FIoStatus(EIoErrorCode::InvalidParameter, "Destination buffer is smaller than the requested range");
+        }
+
         const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
         const uint64_t CompressionBlockSize = TocResource.Header.CompressionBlockSize;
-        FIoBuffer UncompressedBuffer(ResolvedSize);
         if (ResolvedSize == 0) {
-            return UncompressedBuffer;
+            return ResolvedSize;
         }
 
         // From here on we are reading / decompressing at least one block
@@ -449,10 +682,32 @@ public:
         int32_t FirstBlockIndex = int32_t(ResolvedOffset / CompressionBlockSize);
         int32_t LastBlockIndex = int32_t((Align(ResolvedOffset + ResolvedSize, CompressionBlockSize) - 1) / CompressionBlockSize);
 
+        // Blocks already in the block cache skip the IO and the decode entirely.
+        FIoBlockCache::FBlockRef CachedBlocks[2];
+        const uint64_t CacheGeneration = GetCacheGeneration();
+
         // Lambda to kick off a read with a sufficient output buffer.
-        auto LaunchBlockRead = [&TocResource, this](int32_t BlockIndex, std::vector<uint8_t>& DestinationBuffer, std::atomic_bool* OutReadSucceeded) {
+        auto LaunchBlockRead = [&TocResource, &CachedBlocks, &Destination, ResolvedOffset, ResolvedSize, bUseBlockCache, this](int32_t BlockIndex, uint8_t BufferIndex, std::vector<uint8_t>& DestinationBuffer, std::atomic_bool* OutReadSucceeded) {
+            if (bUseBlockCache) {
+                CachedBlocks[BufferIndex] = FIoBlockCache::Get().Find(MakeBlockKey(BlockIndex));
+            }
+            if (CachedBlocks[BufferIndex]) {
+                OutReadSucceeded->store(true);
+                return FTaskHandle();
+            }
+
             const uint64_t CompressionBlockSize = TocResource.Header.CompressionBlockSize;
             const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndex];
+            int32_t PartitionIndex = int32_t(CompressionBlock.GetOffset() / TocResource.Header.PartitionSize);
+            int64_t PartitionOffset = int64_t(CompressionBlock.GetOffset() % TocResource.Header.PartitionSize);
+
+            // Raw blocks map 1:1 onto the chunk, so only the requested slice is read and it lands in place
+            if (IsRawBlock(CompressionBlock)) {
+                const uint64_t BlockStart = uint64_t(BlockIndex) * CompressionBlockSize;
+                const uint64_t SliceStart = std::max(BlockStart, ResolvedOffset);
+                const uint64_t SliceEnd = std::min(BlockStart + CompressionBlock.GetUncompressedSize(), ResolvedOffset + ResolvedSize);
+                return StartAsyncRead(PartitionIndex, PartitionOffset + int64_t(SliceStart - BlockStart), int64_t(SliceEnd - SliceStart), Destination.data() + (SliceStart - ResolvedOffset), OutReadSucceeded);
+            }
 
             // CompressionBlockSize is technically the _uncompressed_ block size, however it's a good
             // size to use for reuse as block compression can vary wildly and we want to be able to
@@ -464,15 +719,21 @@ public:
                 DestinationBuffer.resize(CompressedBufferSizeNeeded);
             }
 
-            int32_t PartitionIndex = int32_t(CompressionBlock.GetOffset() / TocResource.Header.PartitionSize);
-            int64_t PartitionOffset = int64_t(CompressionBlock.GetOffset() % TocResource.Header.PartitionSize);
             return StartAsyncRead(PartitionIndex, PartitionOffset, SizeForDecrypt, DestinationBuffer.data(), OutReadSucceeded);
         };
 
         // Kick off the first async read
-        std::future<void> NextReadRequest;
+        FTaskHandle NextReadRequest;
         uint8_t NextReadBufferIndex = 0;
-        NextReadRequest = LaunchBlockRead(FirstBlockIndex, CompressedBuffers[NextReadBufferIndex], &AsyncReadSucceeded[NextReadBufferIndex]);
+
+        // However this returns, even by a throwing decode, the next block's read may still be writing into
+        // CompressedBuffers or Destination and has to land before they go away
+        struct FWaitOnExit {
+            const FTaskHandle& Request;
+            ~FWaitOnExit() { Request.Wait(); }
+        } WaitOnExit { NextReadRequest };
+
+        NextReadRequest = LaunchBlockRead(FirstBlockIndex, NextReadBufferIndex, CompressedBuffers[NextReadBufferIndex], &AsyncReadSucceeded[NextReadBufferIndex]);
 
         uint64_t UncompressedDestinationOffset = 0;
         uint64_t OffsetInBlock = ResolvedOffset % CompressionBlockSize;
@@ -480,16 +741,16 @@ public:
         std::vector<uint8_t> TempBuffer;
         for (int32_t BlockIndex = FirstBlockIndex; BlockIndex <= LastBlockIndex; ++BlockIndex) {
             // Kick off the next block's IO if there is one
-            std::future<void> ReadRequest(std::move(NextReadRequest));
+            FTaskHandle ReadRequest(std::move(NextReadRequest));
             uint8_t OurBufferIndex = NextReadBufferIndex;
             if (BlockIndex + 1 <= LastBlockIndex) {
                 NextReadBufferIndex = NextReadBufferIndex ^ 1;
-                NextReadRequest = LaunchBlockRead(BlockIndex + 1, CompressedBuffers[NextReadBufferIndex], &AsyncReadSucceeded[NextReadBufferIndex]);
+                NextReadRequest = LaunchBlockRead(BlockIndex + 1, NextReadBufferIndex, CompressedBuffers[NextReadBufferIndex], &AsyncReadSucceeded[NextReadBufferIndex]);
             }
 
             // Now, wait for _our_ block's IO
             {
-                ReadRequest.wait();
+                ReadRequest.Wait();
             }
 
             if (AsyncReadSucceeded[OurBufferIndex] == false) {
@@ -497,50 +758,384 @@ public:
             }
 
             const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndex];
+            uint8_t* UncompressedDestination = Destination.data() + UncompressedDestinationOffset;
+            const uint32_t UncompressedSize = CompressionBlock.GetUncompressedSize();
+            const uint64_t CopySize = std::min(static_cast<uint64_t>(UncompressedSize) - OffsetInBlock, RemainingSize);
 
-            // This also happened in the LaunchBlockRead call, so we know the buffer has the necessary size.
-            uint32_t RawSize = Align(CompressionBlock.GetCompressedSize(), FAESKey::AESBlockSize);
-            if (EnumHasAnyFlags(TocResource.Header.ContainerFlags, EIoContainerFlags::Encrypted)) {
-                TocReader.GetDecryptionKey().DecryptData(CompressedBuffers[OurBufferIndex].data(), RawSize);
+            if (const FIoBlockCache::FBlockRef& CachedBlock = CachedBlocks[OurBufferIndex]) {
+                memcpy(UncompressedDestination, CachedBlock->data() + OffsetInBlock, CopySize);
+            }
+            else if (IsRawBlock(CompressionBlock)) {
+                // Already read into place
+            }
+            else if (!DecodeBlock(BlockIndex, CompressedBuffers[OurBufferIndex].data(), UncompressedDestination, OffsetInBlock, CopySize, TempBuffer, CacheGeneration, bUseBlockCache)) {
+                return FIoStatus(EIoErrorCode::ReadError, "Failed uncompressing chunk");
             }
 
-            std::string CompressionMethod = TocResource.CompressionMethods[CompressionBlock.GetCompressionMethodIndex()];
-            uint8_t* UncompressedDestination = UncompressedBuffer.Data() + UncompressedDestinationOffset;
-            const uint32_t UncompressedSize = CompressionBlock.GetUncompressedSize();
-            if (CompressionMethod.contains("None")) {
-                uint64_t CopySize = std::min(static_cast<uint64_t>(UncompressedSize) - OffsetInBlock, RemainingSize);
-                memcpy(UncompressedDestination, CompressedBuffers[OurBufferIndex].data() + OffsetInBlock, CopySize);
-                UncompressedDestinationOffset += CopySize;
-                RemainingSize -= CopySize;
+            CachedBlocks[OurBufferIndex].reset();
+            UncompressedDestinationOffset += CopySize;
+            RemainingSize -= CopySize;
+            OffsetInBlock = 0;
+        }
+        return ResolvedSize;
+    }
+
+    // One disk read covering a run of blocks that sit close together in one partition
+    struct FCoalescedRead {
+        int32_t PartitionIndex;
+        uint64_t PartitionOffset;
+        uint64_t Size;
+        uint32_t FirstBlock; // Position in the block list the reads were built from
+        uint32_t BlockCount;
+    };
+
+    // Small gaps between blocks are cheaper to read through than to split the read at
+    static constexpr uint64_t MaxCoalescedReadSize = 1024 * 1024;
+    static constexpr uint64_t MaxCoalescedReadGap = 4 * 1024;
+
+    // BlockIndices has to be sorted by container offset and free of duplicates
+    std::vector<FCoalescedRead> CoalesceBlockReads(const std::vector<int32_t>& BlockIndices) const {
+        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+        const uint64_t PartitionSize = TocResource.Header.PartitionSize;
+
+        std::vector<FCoalescedRead> Reads;
+        for (uint32_t Position = 0; Position < BlockIndices.size(); ++Position) {
+            const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndices[Position]];
+            const int32_t PartitionIndex = int32_t(CompressionBlock.GetOffset() / PartitionSize);
+            const uint64_t BlockStart = CompressionBlock.GetOffset() % PartitionSize;
+            const uint64_t BlockEnd = BlockStart + Align(CompressionBlock.GetCompressedSize(), FAESKey::AESBlockSize);
+
+            if (!Reads.empty()) {
+                FCoalescedRead& LastRead = Reads.back();
+                const uint64_t LastReadEnd = LastRead.PartitionOffset + LastRead.Size;
+                if (LastRead.PartitionIndex == PartitionIndex && BlockStart >= LastReadEnd && BlockStart - LastReadEnd <= MaxCoalescedReadGap && BlockEnd - LastRead.PartitionOffset <= MaxCoalescedReadSize) {
+                    LastRead.Size = BlockEnd - LastRead.PartitionOffset;
+                    LastRead.BlockCount++;
+                    continue;
+                }
+            }
+            Reads.push_back({ PartitionIndex, BlockStart, BlockEnd - BlockStart, Position, 1 });
+        }
+        return Reads;
+    }
+
+    std::vector<TIoStatusOr<FIoBuffer>> ReadBatch(std::span<const FIoChunkId> ChunkIds) const {
+        // Where one chunk's part of a block ends up
+        struct FBlockTarget {
+            uint32_t ChunkSlot;
+            uint64_t DestinationOffset;
+            uint64_t OffsetInBlock;
+            uint64_t CopySize;
+        };
+
+        struct FBatchBlock {
+            int32_t BlockIndex;
+            FIoBlockCache::FBlockRef CachedBlock;
+            std::vector<FBlockTarget> Targets;
+        };
+
+
+        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+        const uint64_t CompressionBlockSize = TocResource.Header.CompressionBlockSize;
+        const uint64_t PartitionSize = TocResource.Header.PartitionSize;
+
+        std::vector<TIoStatusOr<FIoBuffer>> Results(ChunkIds.size());
+        std::vector<std::optional<FIoBuffer>> Buffers(ChunkIds.size());
+        std::unique_ptr<std::atomic_bool[]> FailedChunks(new std::atomic_bool[ChunkIds.size()]());
+
+        const uint64_t CacheGeneration = GetCacheGeneration();
+
+        // Gather every block the batch touches, blocks shared between chunks are only listed once
+        TMap<int32_t, uint32_t> BlockSlots;
+        std::vector<FBatchBlock> Blocks;
+        for (uint32_t ChunkSlot = 0; ChunkSlot < ChunkIds.size(); ++ChunkSlot) {
+            const FIoOffsetAndLength* OffsetAndLength = TocReader.GetOffsetAndLength(ChunkIds[ChunkSlot]);
+            if (!OffsetAndLength) {
+                Results[ChunkSlot] = FIoStatus(EIoErrorCode::NotFound, "Unknown chunk ID");
+                continue;
+            }
+
+            const uint64_t ChunkOffset = OffsetAndLength->GetOffset();
+            const uint64_t ChunkSize = OffsetAndLength->GetLength();
+            Buffers[ChunkSlot].emplace(ChunkSize);
+            if (ChunkSize == 0) {
+                continue;
+            }
+
+            const int32_t FirstBlockIndex = int32_t(ChunkOffset / CompressionBlockSize);
+            const int32_t LastBlockIndex = int32_t((Align(ChunkOffset + ChunkSize, CompressionBlockSize) - 1) / CompressionBlockSize);
+            for (int32_t BlockIndex = FirstBlockIndex; BlockIndex <= LastBlockIndex; ++BlockIndex) {
+                const uint64_t BlockStart = uint64_t(BlockIndex) * CompressionBlockSize;
+                const uint64_t SliceStart = std::max(BlockStart, ChunkOffset);
+                const uint64_t SliceEnd = std::min(BlockStart + TocResource.CompressionBlocks[BlockIndex].GetUncompressedSize(), ChunkOffset + ChunkSize);
+
+                auto [It, bInserted] = BlockSlots.try_emplace(BlockIndex, uint32_t(Blocks.size()));
+                if (bInserted) {
+                    Blocks.push_back({ BlockIndex, FIoBlockCache::Get().Find(MakeBlockKey(BlockIndex)), {} });
+                }
+                Blocks[It->second].Targets.push_back({ ChunkSlot, SliceStart - ChunkOffset, SliceStart - BlockStart, SliceEnd - SliceStart });
+            }
+        }
+
+        // Cached blocks are handed out right away, the rest is read in container order
+        std::vector<uint32_t> PendingBlocks;
+        for (uint32_t BlockSlot = 0; BlockSlot < Blocks.size(); ++BlockSlot) {
+            const FBatchBlock& Block = Blocks[BlockSlot];
+            if (!Block.CachedBlock) {
+                PendingBlocks.push_back(BlockSlot);
+                continue;
+            }
+
+            for (const FBlockTarget& Target : Block.Targets) {
+                memcpy(Buffers[Target.ChunkSlot]->Data() + Target.DestinationOffset, Block.CachedBlock->data() + Target.OffsetInBlock, Target.CopySize);
+            }
+        }
+
+        std::sort(PendingBlocks.begin(), PendingBlocks.end(), [&](uint32_t A, uint32_t B) {
+            return TocResource.CompressionBlocks[Blocks[A].BlockIndex].GetOffset() < TocResource.CompressionBlocks[Blocks[B].BlockIndex].GetOffset();
+        });
+
+        // Reads cover the blocks PendingBlocks[FirstBlock, FirstBlock + BlockCount)
+        std::vector<int32_t> PendingBlockIndices;
+        PendingBlockIndices.reserve(PendingBlocks.size());
+        for (uint32_t BlockSlot : PendingBlocks) {
+            PendingBlockIndices.push_back(Blocks[BlockSlot].BlockIndex);
+        }
+        const std::vector<FCoalescedRead> Reads = CoalesceBlockReads(PendingBlockIndices);
+
+        // All reads are queued up front so the backend can keep them in flight together. Every read decodes its
+        // own blocks once it lands, a block shared by several chunks is decoded once and copied to each.
+        std::vector<std::vector<uint8_t>> ReadBuffers(Reads.size());
+        std::atomic_uint32_t RemainingReads { uint32_t(Reads.size()) };
+        FTaskHandle ReadsDone = FTaskExecutor::MakePendingHandle();
+        if (Reads.empty()) {
+            FTaskExecutor::Complete(ReadsDone);
+        }
+
+        for (uint32_t ReadIndex = 0; ReadIndex < Reads.size(); ++ReadIndex) {
+            const FCoalescedRead& Read = Reads[ReadIndex];
+            std::vector<uint8_t>& CompressedBuffer = ReadBuffers[ReadIndex];
+            CompressedBuffer.resize(Read.Size);
+
+            auto DecodeRead = [this, &Blocks, &PendingBlocks, &Buffers, &FailedChunks, &TocResource, &CompressedBuffer, &RemainingReads, ReadsDone, PartitionSize, CacheGeneration, Read](bool bReadSucceeded) {
+                // The executor swallows exceptions, so a decode that throws has to count down here too or the
+                // wait below never returns. Every chunk the read feeds fails unless the loop got to the end.
+                struct FFinishOnExit {
+                    const std::vector<FBatchBlock>& Blocks;
+                    const std::vector<uint32_t>& PendingBlocks;
+                    std::unique_ptr<std::atomic_bool[]>& FailedChunks;
+                    std::atomic_uint32_t& RemainingReads;
+                    const FTaskHandle& ReadsDone;
+                    const FCoalescedRead& Read;
+                    bool bDone = false;
+                    ~FFinishOnExit() {
+                        for (uint32_t PendingIndex = Read.FirstBlock; !bDone && PendingIndex < Read.FirstBlock + Read.BlockCount; ++PendingIndex) {
+                            for (const FBlockTarget& Target : Blocks[PendingBlocks[PendingIndex]].Targets) {
+                                FailedChunks[Target.ChunkSlot] = true;
+                            }
+                        }
+                        if (RemainingReads.fetch_sub(1) == 1) {
+                            FTaskExecutor::Complete(ReadsDone);
+                        }
+                    }
+                } FinishOnExit { Blocks, PendingBlocks, FailedChunks, RemainingReads, ReadsDone, Read };
+
+                std::vector<uint8_t> TempBuffer;
+                std::vector<uint8_t> DecodedBlock;
+                for (uint32_t PendingIndex = Read.FirstBlock; PendingIndex < Read.FirstBlock + Read.BlockCount; ++PendingIndex) {
+                    const FBatchBlock& Block = Blocks[PendingBlocks[PendingIndex]];
+                    const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[Block.BlockIndex];
+                    uint8_t* CompressedSource = CompressedBuffer.data() + (CompressionBlock.GetOffset() % PartitionSize - Read.PartitionOffset);
+
+                    bool bDecoded = bReadSucceeded;
+                    if (bDecoded && Block.Targets.size() == 1) {
+                        const FBlockTarget& Target = Block.Targets[0];
+                        bDecoded = DecodeBlock(Block.BlockIndex, CompressedSource, Buffers[Target.ChunkSlot]->Data() + Target.DestinationOffset, Target.OffsetInBlock, Target.CopySize, TempBuffer, CacheGeneration);
+                    }
+                    else if (bDecoded) {
+                        DecodedBlock.resize(CompressionBlock.GetUncompressedSize());
+                        bDecoded = DecodeBlock(Block.BlockIndex, CompressedSource, DecodedBlock.data(), 0, DecodedBlock.size(), TempBuffer, CacheGeneration);
+                        for (const FBlockTarget& Target : Block.Targets) {
+                            if (bDecoded) {
+                                memcpy(Buffers[Target.ChunkSlot]->Data() + Target.DestinationOffset, DecodedBlock.data() + Target.OffsetInBlock, Target.CopySize);
+                            }
+                        }
+                    }
+
+                    if (!bDecoded) {
+                        for (const FBlockTarget& Target : Block.Targets) {
+                            FailedChunks[Target.ChunkSlot] = true;
+                        }
+                    }
+                }
+                FinishOnExit.bDone = true;
+            };
+
+            ReadContainerRangeAsync(Read.PartitionIndex, Read.PartitionOffset, Read.Size, CompressedBuffer.data(), [DecodeRead](bool bReadSucceeded) {
+                FTaskExecutor::Get().Enqueue([DecodeRead, bReadSucceeded]() { DecodeRead(bReadSucceeded); });
+            });
+        }
+
+        ReadsDone.Wait();
+
+        for (uint32_t ChunkSlot = 0; ChunkSlot < ChunkIds.size(); ++ChunkSlot) {
+            if (!Buffers[ChunkSlot]) {
+                continue;
+            }
+
+            if (FailedChunks[ChunkSlot]) {
+                Results[ChunkSlot] = FIoStatus(EIoErrorCode::ReadError, "Failed reading or uncompressing chunk");
             }
             else {
-                bool bUncompressed;
-                if (OffsetInBlock || RemainingSize < UncompressedSize) {
-                    // If this block is larger than the amount of data actuall requested, decompress to a temp
-                    // buffer and then copy out. Should never happen when reading the entire chunk.
-                    TempBuffer.clear();
-                    TempBuffer.resize(UncompressedSize);
-                    FCompression::DecompressMemory(CompressionMethod, TempBuffer.data(), UncompressedSize, CompressedBuffers[OurBufferIndex].data(), CompressionBlock.GetCompressedSize());
-                    bUncompressed = std::any_of(TempBuffer.begin(), TempBuffer.end(), [](uint8_t byte) { return byte != 0; });
-                    uint64_t CopySize = std::min(static_cast<uint64_t>(UncompressedSize) - OffsetInBlock, RemainingSize);
-                    memcpy(UncompressedDestination, TempBuffer.data() + OffsetInBlock, CopySize);
-                    UncompressedDestinationOffset += CopySize;
-                    RemainingSize -= CopySize;
+                Results[ChunkSlot] = std::move(*Buffers[ChunkSlot]);
+            }
+        }
+        return Results;
+    }
+
+    void Prefetch(std::span<const FIoChunkId> ChunkIds, const TSharedPtr<FIoPrefetchRequest>& Request) const {
+        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+        const uint64_t CompressionBlockSize = TocResource.Header.CompressionBlockSize;
+
+        std::vector<int32_t> BlockIndices;
+        for (const FIoChunkId& ChunkId : ChunkIds) {
+            const FIoOffsetAndLength* OffsetAndLength = TocReader.GetOffsetAndLength(ChunkId);
+            if (!OffsetAndLength || OffsetAndLength->GetLength() == 0) {
+                continue;
+            }
+
+            const int32_t FirstBlockIndex = int32_t(OffsetAndLength->GetOffset() / CompressionBlockSize);
+            const int32_t LastBlockIndex = int32_t((Align(OffsetAndLength->GetOffset() + OffsetAndLength->GetLength(), CompressionBlockSize) - 1) / CompressionBlockSize);
+            for (int32_t BlockIndex = FirstBlockIndex; BlockIndex <= LastBlockIndex; ++BlockIndex) {
+                BlockIndices.push_back(BlockIndex);
+            }
+        }
+
+        std::sort(BlockIndices.begin(), BlockIndices.end(), [&TocResource](int32_t A, int32_t B) {
+            return TocResource.CompressionBlocks[A].GetOffset() < TocResource.CompressionBlocks[B].GetOffset();
+        });
+        BlockIndices.erase(std::unique(BlockIndices.begin(), BlockIndices.end()), BlockIndices.end());
+
+        for (const FCoalescedRead& Read : CoalesceBlockReads(BlockIndices)) {
+            std::vector<int32_t> ReadBlockIndices(BlockIndices.begin() + Read.FirstBlock, BlockIndices.begin() + Read.FirstBlock + Read.BlockCount);
+
+            Request->PendingReads.fetch_add(1, std::memory_order_relaxed);
+            {
+                std::lock_guard<std::mutex> Lock(PrefetchLock);
+                PendingPrefetches++;
+            }
+
+            // Owned by the task, so the counts are released once it's destroyed: after running, after throwing,
+            // or unrun when it's cancelled. The last one wakes up the destructor, under the lock so the reader
+            // can't be gone before the notify.
+            std::shared_ptr<void> ReleasePending(nullptr, [this, Request](void*) {
+                Request->PendingReads.fetch_sub(1, std::memory_order_release);
+
+                std::lock_guard<std::mutex> Lock(PrefetchLock);
+                if (--PendingPrefetches == 0) {
+                    PrefetchesDone.notify_all();
                 }
-                else {
-                    FCompression::DecompressMemory(CompressionMethod, UncompressedDestination, UncompressedSize, CompressedBuffers[OurBufferIndex].data(), CompressionBlock.GetCompressedSize());
-                    bUncompressed = std::any_of(UncompressedDestination, UncompressedDestination + UncompressedSize, [](uint8_t byte) { return byte != 0; });
-                    UncompressedDestinationOffset += UncompressedSize;
-                    RemainingSize -= UncompressedSize;
+            });
+
+            FTaskExecutor::Get().EnqueueBackground([this, Request, Read, ReadBlockIndices = std::move(ReadBlockIndices), ReleasePending = std::move(ReleasePending)]() {
+                if (!Request->IsCancelled() && !bClosing.load(std::memory_order_relaxed)) {
+                    PrefetchRead(Read, ReadBlockIndices, *Request);
                 }
+            }, this);
+        }
+    }
 
-                if (!bUncompressed) {
-                    return FIoStatus(EIoErrorCode::ReadError, "Failed uncompressing chunk");
+    TIoStatusOr<FIoVerifyResult> Verify(const FIoVerifyOptions& Options) const {
+        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+        if (TocResource.Header.Version < static_cast<uint8_t>(EIoStoreTocVersion::ReplaceIoChunkHashWithIoHash)) {
+            return FIoStatus(EIoErrorCode::InvalidCode, "Container predates blake3 chunk hashes");
+        }
+        if (TocResource.ChunkMetas.size() != TocResource.ChunkIds.size()) {
+            return FIoStatus(EIoErrorCode::CorruptToc, "Container has no chunk metas");
+        }
+
+        FIoVerifyResult Result;
+        Result.ContainerName = GetContainerName();
+
+        // Taking a chunk every time the rate adds up to a whole one spreads the sample evenly
+        std::vector<int32_t> TocEntryIndices;
+        double SampleBudget = 0.0;
+        for (int32_t TocEntryIndex = 0; TocEntryIndex < int32_t(TocResource.ChunkIds.size()); ++TocEntryIndex) {
+            if (TocResource.ChunkMetas[TocEntryIndex].ChunkHash.IsZero()) {
+                Result.SkippedChunks++;
+                continue;
+            }
+
+            SampleBudget += Options.SampleRate;
+            if (SampleBudget < 1.0) {
+                Result.SkippedChunks++;
+                continue;
+            }
+
+            SampleBudget -= 1.0;
+            TocEntryIndices.push_back(TocEntryIndex);
+        }
+
+        // Container order keeps the disk reads sequential even with every worker pulling chunks
+        std::sort(TocEntryIndices.begin(), TocEntryIndices.end(), [&TocResource](int32_t A, int32_t B) {
+            return TocResource.ChunkOffsetAndLengths[A].GetOffset() < TocResource.ChunkOffsetAndLengths[B].GetOffset();
+        });
+
+        AdviseAccessPattern(EFileAccessPattern::Sequential);
+        const auto StartTime = std::chrono::steady_clock::now();
+
+        // One task per worker pulling chunks off a shared cursor, so a few huge chunks don't leave workers idle
+        std::atomic_uint32_t NextEntry { 0 };
+        std::mutex ResultMutex;
+        auto VerifyChunks = [&]() {
+            std::vector<uint8_t> Buffer;
+            std::vector<FIoChunkId> Mismatches, FailedReads;
+            uint64_t VerifiedBytes = 0;
+
+            for (uint32_t Entry = NextEntry.fetch_add(1, std::memory_order_relaxed); Entry < TocEntryIndices.size(); Entry = NextEntry.fetch_add(1, std::memory_order_relaxed)) {
+                const int32_t TocEntryIndex = TocEntryIndices[Entry];
+                const FIoChunkId& ChunkId = TocResource.ChunkIds[TocEntryIndex];
+
+                Buffer.resize(TocResource.ChunkOffsetAndLengths[TocEntryIndex].GetLength());
+                if (!Read(ChunkId, FIoReadOptions(), Buffer, false).IsOk()) {
+                    FailedReads.push_back(ChunkId);
+                    continue;
+                }
+
+                if (FIoHash::HashBuffer(Buffer.data(), Buffer.size()) != TocResource.ChunkMetas[TocEntryIndex].ChunkHash) {
+                    Mismatches.push_back(ChunkId);
                 }
+                VerifiedBytes += Buffer.size();
             }
-            OffsetInBlock = 0;
+
+            std::lock_guard<std::mutex> Lock(ResultMutex);
+            Result.Mismatches.insert(Result.Mismatches.end(), Mismatches.begin(), Mismatches.end());
+            Result.FailedReads.insert(Result.FailedReads.end(), FailedReads.begin(), FailedReads.end());
+            Result.VerifiedBytes += VerifiedBytes;
+        };
+
+        const uint32_t TaskCount = std::min<uint32_t>(FTaskExecutor::Get().GetNumWorkers(), uint32_t(TocEntryIndices.size()));
+        std::vector<FTaskHandle> Tasks;
+        for (uint32_t TaskIndex = 0; TaskIndex < TaskCount; ++TaskIndex) {
+            Tasks.push_back(FTaskExecutor::Get().Launch(VerifyChunks));
         }
-        return UncompressedBuffer;
+        for (const FTaskHandle& Task : Tasks) {
+            Task.Wait();
+        }
+
+        Result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+        Result.VerifiedChunks = uint32_t(TocEntryIndices.size() - Result.FailedReads.size());
+        AdviseAccessPattern(EFileAccessPattern::Normal);
+        return Result;
+    }
+
+    // Prefetches never outlive the reader, queued ones are cancelled and running ones are waited for
+    ~FIoStoreReaderImpl() {
+        bClosing.store(true, std::memory_order_relaxed);
+        FTaskExecutor::Get().CancelBackground(this);
+
+        std::unique_lock<std::mutex> Lock(PrefetchLock);
+        PrefetchesDone.wait(Lock, [this]() { return PendingPrefetches == 0; });
     }
 
     TIoStatusOr<FIoStoreCompressedReadResult> ReadCompressed(const FIoChunkId& ChunkId, const FIoReadOptions& Options, bool bDecrypt) const {
@@ -603,12 +1198,7 @@ public:
             int32_t PartitionIndex = int32_t(CompressionBlock.GetOffset() / TocResource.Header.PartitionSize);
             int64_t PartitionOffset = int64_t(CompressionBlock.GetOffset() % TocResource.Header.PartitionSize);
 
-            std::atomic_bool bReadSucceeded;
-            std::future<void> ReadTask = StartAsyncRead(PartitionIndex, PartitionOffset, TotalAlignedSize, OutputBuffer, &bReadSucceeded);
-
-            {
-                ReadTask.wait();
-            }
+            bool bReadSucceeded = ReadContainerRange(PartitionIndex, PartitionOffset, TotalAlignedSize, OutputBuffer);
 
             if (bReadSucceeded == false) {
                 LOG_ERROR("Read from container {0} failed (partition {1}, offset {2}, size {3})", ContainerPath, PartitionIndex, PartitionOffset, TotalAlignedSize);
@@ -694,6 +1284,37 @@ public:
         }
     }
 
+    void AdviseAccessPattern(EFileAccessPattern Pattern) const {
+        for (const auto& ContainerFileAccess : ContainerFileAccessors) {
+            if (ContainerFileAccess->Mapping) {
+                ContainerFileAccess->Mapping->Advise(Pattern);
+            }
+        }
+    }
+
+    void AdviseWillNeed(const FIoChunkId& ChunkId) const {
+        const FIoOffsetAndLength* OffsetAndLength = TocReader.GetOffsetAndLength(ChunkId);
+        if (!OffsetAndLength || OffsetAndLength->GetLength() == 0) {
+            return;
+        }
+
+        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+        const uint64_t CompressionBlockSize = TocResource.Header.CompressionBlockSize;
+        const int32_t FirstBlockIndex = int32_t(OffsetAndLength->GetOffset() / CompressionBlockSize);
+        const int32_t LastBlockIndex = int32_t((Align(OffsetAndLength->GetOffset() + OffsetAndLength->GetLength(), CompressionBlockSize) - 1) / CompressionBlockSize);
+
+        // A chunk's blocks are stored back to back in one partition, same as Read assumes
+        const FIoStoreTocCompressedBlockEntry& FirstBlock = TocResource.CompressionBlocks[FirstBlockIndex];
+        const FIoStoreTocCompressedBlockEntry& LastBlock = TocResource.CompressionBlocks[LastBlockIndex];
+        const int32_t PartitionIndex = static_cast<int32_t>(FirstBlock.GetOffset() / TocResource.Header.PartitionSize);
+        const uint64_t ReadStartOffset = FirstBlock.GetOffset() % TocResource.Header.PartitionSize;
+        const uint64_t ReadLength = LastBlock.GetOffset() + Align(LastBlock.GetCompressedSize(), FAESKey::AESBlockSize) - FirstBlock.GetOffset();
+
+        if (const TSharedPtr<FContainerFileMapping>& Mapping = ContainerFileAccessors[PartitionIndex]->Mapping) {
+            Mapping->Prefetch(ReadStartOffset, ReadLength);
+        }
+    }
+
     void GetContainerFilePaths(std::vector<std::string>& OutPaths) {
         std::string Sb;
 
@@ -716,9 +1337,94 @@ public:
         return TocReader.GetOffsetAndLength(ChunkId);
     }
 private:
+    // Resolves the TOC's compression methods and opens every .ucas partition
+    FIoStatus OpenContainer(const std::string& TocFilePath) {
+        FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+
+        CompressionMethods.reserve(TocResource.CompressionMethods.size());
+        Decompressors.reserve(TocResource.CompressionMethods.size());
+        for (const std::string& MethodName : TocResource.CompressionMethods) {
+            ECompressionMethod Method = FCompression::GetCompressionMethod(MethodName);
+            if (Method == ECompressionMethod::Unknown) {
+                LOG_WARN("Container '{0}' uses unsupported compression method '{1}'", ContainerPath, MethodName);
+            }
+            else if (Method == ECompressionMethod::Oodle && !Oodle::IsLoaded()) {
+                LOG_WARN("Container '{0}' uses Oodle but the Oodle library isn't loaded, its compressed blocks will fail to read", ContainerPath);
+            }
+
+            CompressionMethods.push_back(Method);
+            Decompressors.push_back(FCompression::GetDecompressor(Method));
+        }
+
+        ContainerFileAccessors.reserve(TocResource.Header.PartitionCount);
+        for (uint32_t PartitionIndex = 0; PartitionIndex < TocResource.Header.PartitionCount; ++PartitionIndex) {
+            std::string ContainerFilePath;
+            ContainerFilePath.append(ContainerPath);
+            if (PartitionIndex > 0) {
+                ContainerFilePath.append("_s");
+                ContainerFilePath.append(std::to_string(PartitionIndex));
+            }
+            ContainerFilePath.append(".ucas");
+
+            ContainerFileAccessors.emplace_back(std::unique_ptr<FContainerFileAccess>(new FContainerFileAccess(ContainerFilePath)));
+            if (ContainerFileAccessors[PartitionIndex]->IsValid() == false) {
+                return FIoStatusBuilder(EIoErrorCode::FileOpenFailed) << "Failed to open IoStore container file '" << TocFilePath << "'";
+            }
+        }
+
+        return FIoStatus::Ok;
+    }
+
+    // Reads one coalesced range and decodes the blocks the block cache doesn't have yet
+    void PrefetchRead(const FCoalescedRead& Read, const std::vector<int32_t>& BlockIndices, const FIoPrefetchRequest& Request) const {
+        const FIoStoreTocResource& TocResource = TocReader.GetTocResource();
+
+        const uint64_t CacheGeneration = GetCacheGeneration();
+
+        // Demand reads may have loaded some of the blocks since this was queued
+        std::vector<int32_t> MissingBlocks;
+        for (int32_t BlockIndex : BlockIndices) {
+            if (!FIoBlockCache::Get().Find(MakeBlockKey(BlockIndex))) {
+                MissingBlocks.push_back(BlockIndex);
+            }
+        }
+        if (MissingBlocks.empty()) {
+            return;
+        }
+
+        std::vector<uint8_t> CompressedBuffer(Read.Size);
+        if (!ReadContainerRange(Read.PartitionIndex, Read.PartitionOffset, Read.Size, CompressedBuffer.data())) {
+            return;
+        }
+
+        std::vector<uint8_t> TempBuffer;
+        for (int32_t BlockIndex : MissingBlocks) {
+            if (Request.IsCancelled() || bClosing.load(std::memory_order_relaxed)) {
+                return;
+            }
+
+            const FIoStoreTocCompressedBlockEntry& CompressionBlock = TocResource.CompressionBlocks[BlockIndex];
+            uint8_t* CompressedSource = CompressedBuffer.data() + (CompressionBlock.GetOffset() % TocResource.Header.PartitionSize - Read.PartitionOffset);
+
+            std::shared_ptr<std::vector<uint8_t>> Block = std::make_shared<std::vector<uint8_t>>(CompressionBlock.GetUncompressedSize());
+            if (DecodeBlock(BlockIndex, CompressedSource, Block->data(), 0, Block->size(), TempBuffer, CacheGeneration, false)) {
+                FIoBlockCache::Get().Insert(MakeBlockKey(BlockIndex), Block, CacheGeneration);
+            }
+        }
+    }
+
     FIoStoreTocReader TocReader;
     std::vector<TUniquePtr<FContainerFileAccess>> ContainerFileAccessors;
     std::string ContainerPath;
+
+    // Indexed by the compression method index of a block, resolved once when the container is mounted
+    std::vector<ECompressionMethod> CompressionMethods;
+    std::vector<FDecompressionFunc> Decompressors;
+
+    mutable std::mutex PrefetchLock;
+    mutable std::condition_variable PrefetchesDone;
+    mutable int32_t PendingPrefetches = 0;
+    std::atomic_bool bClosing { false };
 };
 
 FIoStoreReader::FIoStoreReader() : Impl(new FIoStoreReaderImpl()) {}
@@ -728,6 +1434,10 @@ FIoStatus FIoStoreReader::Initialize(const std::string& InContainerPath, const T
     return Impl->Initialize(InContainerPath, InDecryptionKeys);
 }
 
+FIoStatus FIoStoreReader::Initialize(const std::string& InContainerPath, FIoStoreTocResource&& InTocResource, const TMap<FGuid, FAESKey>& InDecryptionKeys) {
+    return Impl->Initialize(InContainerPath, std::move(InTocResource), InDecryptionKeys);
+}
+
 FIoContainerId FIoStoreReader::GetContainerId() const {
     return Impl->GetContainerId();
 }
@@ -776,6 +1486,27 @@ TIoStatusOr<FIoBuffer> FIoStoreReader::Read(const FIoChunkId& Chunk, const FIoRe
     return Impl->Read(Chunk, Options);
 }
 
+TIoStatusOr<uint64_t> FIoStoreReader::Read(const FIoChunkId& Chunk, const FIoReadOptions& Options, std::span<uint8_t> Destination) const {
+    return Impl->Read(Chunk, Options, Destination);
+}
+
+std::vector<TIoStatusOr<FIoBuffer>> FIoStoreReader::ReadBatch(std::span<const FIoChunkId> Chunks) const {
+    return Impl->ReadBatch(Chunks);
+}
+
+TSharedPtr<FIoPrefetchRequest> FIoStoreReader::Prefetch(std::span<const FIoChunkId> Chunks, TSharedPtr<FIoPrefetchRequest> Request) const {
+    if (!Request) {
+        Request = std::make_shared<FIoPrefetchRequest>();
+    }
+
+    Impl->Prefetch(Chunks, Request);
+    return Request;
+}
+
+TIoStatusOr<FIoVerifyResult> FIoStoreReader::Verify(const FIoVerifyOptions& Options) const {
+    return Impl->Verify(Options);
+}
+
 TIoStatusOr<FIoStoreCompressedReadResult> FIoStoreReader::ReadCompressed(const FIoChunkId& Chunk, const FIoReadOptions& Options, bool bDecrypt) const {
     return Impl->ReadCompressed(Chunk, Options, bDecrypt);
 }
@@ -788,6 +1519,14 @@ const FIoDirectoryIndexReader& FIoStoreReader::GetDirectoryIndexReader() const {
     return Impl->GetDirectoryIndexReader();
 }
 
+std::optional<uint32_t> FIoStoreReader::FindTocEntryIndex(std::string_view Path) const {
+    const FIoDirectoryIndexHandle File = GetDirectoryIndexReader().FindFile(Path);
+    if (!File.IsValid()) {
+        return std::nullopt;
+    }
+    return GetDirectoryIndexReader().GetFileData(File);
+}
+
 uint32_t FIoStoreReader::GetCompressionBlockSize() const {
     return Impl->GetCompressionBlockSize();
 }
@@ -804,6 +1543,14 @@ void FIoStoreReader::EnumerateCompressedBlocksForChunk(const FIoChunkId& Chunk,
     Impl->EnumerateCompressedBlocksForChunk(Chunk, std::move(Callback));
 }
 
+void FIoStoreReader::AdviseAccessPattern(EFileAccessPattern Pattern) const {
+    Impl->AdviseAccessPattern(Pattern);
+}
+
+void FIoStoreReader::AdviseWillNeed(const FIoChunkId& Chunk) const {
+    Impl->AdviseWillNeed(Chunk);
+}
+
 void FIoStoreReader::GetContainerFilePaths(std::vector<std::string>& OutPaths) {
     Impl->GetContainerFilePaths(OutPaths);
 }
@@ -811,23 +1558,22 @@ void FIoStoreReader::GetContainerFilePaths(std::vector<std::string>& OutPaths) {
 void FIoStoreReader::GetFiles(TMap<uint64_t, uint32_t>& OutFileList) const {
     const FIoDirectoryIndexReader& DirectoryIndex = GetDirectoryIndexReader();
 
-    DirectoryIndex.IterateDirectoryIndex(
+    DirectoryIndex.IterateFiles(
         FIoDirectoryIndexHandle::RootDirectory(),
-        "",
-        [&OutFileList](std::string Filename, uint32_t TocEntryIndex) -> bool {
-            OutFileList.insert({ XXH3_64bits(Filename.c_str(), Filename.size()), TocEntryIndex });
+        [&OutFileList](const FIoDirectoryIndexFile& File) -> bool {
+            OutFileList.insert({ XXH3_64bits(File.Path.data(), File.Path.size()), File.TocEntryIndex });
             return true;
         });
 }
 
 void FIoStoreReader::GetFiles(std::vector<std::pair<std::string, uint32_t>>& OutFileList) const {
     const FIoDirectoryIndexReader& DirectoryIndex = GetDirectoryIndexReader();
+    OutFileList.reserve(OutFileList.size() + GetChunkCount());
 
-    DirectoryIndex.IterateDirectoryIndex(
+    DirectoryIndex.IterateFiles(
         FIoDirectoryIndexHandle::RootDirectory(),
-        "",
-        [this, &OutFileList](std::string Filename, uint32_t TocEntryIndex) -> bool {
-            OutFileList.emplace_back(Filename, TocEntryIndex);
+        [&OutFileList](const FIoDirectoryIndexFile& File) -> bool {
+            OutFileList.emplace_back(File.Path, File.TocEntryIndex);
             return true;
         });
 }
@@ -835,11 +1581,10 @@ void FIoStoreReader::GetFiles(std::vector<std::pair<std::string, uint32_t>>& Out
 void FIoStoreReader::GetFilenames(std::vector<std::string>& OutFileList) const {
     const FIoDirectoryIndexReader& DirectoryIndex = GetDirectoryIndexReader();
 
-    DirectoryIndex.IterateDirectoryIndex(
+    DirectoryIndex.IterateFiles(
         FIoDirectoryIndexHandle::RootDirectory(),
-        "",
-        [&OutFileList](std::string Filename, uint32_t TocEntryIndex) -> bool {
-            OutFileList.emplace_back(Filename);
+        [&OutFileList](const FIoDirectoryIndexFile& File) -> bool {
+            OutFileList.emplace_back(File.Path);
             return true;
         });
 }
@@ -847,16 +1592,76 @@ void FIoStoreReader::GetFilenames(std::vector<std::string>& OutFileList) const {
 void FIoStoreReader::GetFilenamesbyBlockIndex(const std::vector<int32_t>& InBlockIndexList, std::vector<std::string>& OutFileList) const {
     const FIoDirectoryIndexReader& DirectoryIndex = GetDirectoryIndexReader();
 
-    DirectoryIndex.IterateDirectoryIndex(
+    DirectoryIndex.IterateFiles(
         FIoDirectoryIndexHandle::RootDirectory(),
-        "",
-        [this, &InBlockIndexList, &OutFileList](std::string Filename, uint32_t TocEntryIndex) -> bool {
+        [this, &InBlockIndexList, &OutFileList](const FIoDirectoryIndexFile& File) -> bool {
             for (int32_t BlockIndex : InBlockIndexList) {
-                if (Impl->TocChunkContainsBlockIndex(TocEntryIndex, BlockIndex)) {
-                    OutFileList.emplace_back(Filename);
+                if (Impl->TocChunkContainsBlockIndex(File.TocEntryIndex, BlockIndex)) {
+                    OutFileList.emplace_back(File.Path);
                     break;
                 }
             }
             return true;
         });
-}
\ No newline at end of file
+}
+
+FIoChunkArchive::FIoChunkArchive(const FIoStoreReader& Reader, const FIoChunkId& InChunkId) : ChunkId(InChunkId) {
+    const FIoOffsetAndLength* OffsetAndLength = Reader.Impl->GetOffsetAndLength(ChunkId);
+    if (!OffsetAndLength) {
+        return;
+    }
+
+    Impl = Reader.Impl;
+    ChunkOffset = OffsetAndLength->GetOffset();
+    ChunkSize = static_cast<int64_t>(OffsetAndLength->GetLength());
+    CompressionBlockSize = Impl->GetCompressionBlockSize();
+}
+
+bool FIoChunkArchive::Serialize(void* V, int64_t Length) {
+    if (!Impl || Length < 0 || Position < 0 || Position + Length > ChunkSize) {
+        return false;
+    }
+
+    uint8_t* Destination = static_cast<uint8_t*>(V);
+
+    // A read covering whole blocks gains nothing from the ring, decode it straight into the destination instead
+    if (Length >= static_cast<int64_t>(CompressionBlockSize)) {
+        if (!Impl->Read(ChunkId, FIoReadOptions(Position, Length), std::span<uint8_t>(Destination, Length)).IsOk()) {
+            return false;
+        }
+        Position += Length;
+        return true;
+    }
+
+    while (Length > 0) {
+        const uint64_t ResolvedOffset = ChunkOffset + Position;
+        const uint64_t OffsetInBlock = ResolvedOffset % CompressionBlockSize;
+        const FIoBlockCache::FBlockRef& Block = GetBlock(int32_t(ResolvedOffset / CompressionBlockSize));
+        if (!Block || OffsetInBlock >= Block->size()) {
+            return false;
+        }
+
+        const int64_t CopySize = std::min(Length, static_cast<int64_t>(Block->size() - OffsetInBlock));
+        memcpy(Destination, Block->data() + OffsetInBlock, CopySize);
+        Destination += CopySize;
+        Position += CopySize;
+        Length -= CopySize;
+    }
+    return true;
+}
+
+const FIoBlockCache::FBlockRef& FIoChunkArchive::GetBlock(int32_t BlockIndex) {
+    for (const FDecodedBlock& DecodedBlock : DecodedBlocks) {
+        if (DecodedBlock.BlockIndex == BlockIndex) {
+            return DecodedBlock.Block;
+        }
+    }
+
+    // Oldest block makes room, reads are mostly forward so it's the least likely to be needed again
+    FDecodedBlock& DecodedBlock = DecodedBlocks[NextDecodedBlock];
+    NextDecodedBlock = (NextDecodedBlock + 1) % DecodedBlockCount;
+
+    DecodedBlock.Block = Impl->ReadBlock(BlockIndex);
+    DecodedBlock.BlockIndex = DecodedBlock.Block ? BlockIndex : -1;
+    return DecodedBlock.Block;
+}
@@ -4,11 +4,15 @@ module;
 
 export module Saturn.IoStore.IoStoreReader;
 
+import <span>;
+import <array>;
 import <vector>;
 import <memory>;
 import <atomic>;
 import <string>;
 import <cstdint>;
+import <optional>;
+import <string_view>;
 import <future>;
 import <functional>;
 
@@ -17,20 +21,62 @@ import Saturn.Core.IoStatus;
 import Saturn.Misc.IoBuffer;
 import Saturn.Encryption.AES;
 import Saturn.Structs.IoChunkId;
+import Saturn.Readers.FArchive;
 import Saturn.Misc.IoReadOptions;
 import Saturn.Structs.IoContainerId;
 import Saturn.IoStore.IoDirectoryIndex;
+import Saturn.IoStore.IoBlockCache;
+import Saturn.Readers.ContainerFileMapping;
 import Saturn.Structs.IoContainerFlags;
 import Saturn.Structs.IoStoreTocResource;
 import Saturn.Structs.IoStoreTocChunkInfo;
 import Saturn.Container.IoStoreCompressedReadResult;
 
+// Tracks background prefetch work. Cancelling skips every block that hasn't been read yet, blocks already
+// decoded stay in the block cache. One request can be shared by prefetches on several readers.
+export class FIoPrefetchRequest {
+public:
+    void Cancel() { bCancelled.store(true, std::memory_order_relaxed); }
+    bool IsCancelled() const { return bCancelled.load(std::memory_order_relaxed); }
+
+    // True once every read queued for this request has run or was skipped
+    bool IsCompleted() const { return PendingReads.load(std::memory_order_acquire) == 0; }
+private:
+    friend class FIoStoreReaderImpl;
+
+    std::atomic_bool bCancelled { false };
+    std::atomic_int32_t PendingReads { 0 };
+};
+
+export struct FIoVerifyOptions {
+    // Share of the chunks to hash, 1 checks every chunk. Sampled chunks are spread evenly over the container.
+    double SampleRate = 1.0;
+};
+
+// Outcome of hashing a container's chunks and comparing them with the hashes stored in its TOC
+export struct FIoVerifyResult {
+    std::string ContainerName;
+    uint32_t VerifiedChunks = 0;
+    uint32_t SkippedChunks = 0; // Not sampled, or the TOC has no hash for them
+    uint64_t VerifiedBytes = 0;
+    double Seconds = 0.0;
+    std::vector<FIoChunkId> Mismatches;
+    std::vector<FIoChunkId> FailedReads;
+
+    bool IsOk() const { return Mismatches.empty() && FailedReads.empty(); }
+    double GetThroughput() const { return Seconds > 0.0 ? VerifiedBytes / Seconds : 0.0; } // Bytes per second
+};
+
 export class FIoStoreReader : public std::enable_shared_from_this<FIoStoreReader> {
 public:
     FIoStoreReader();
     ~FIoStoreReader();
 
     FIoStatus Initialize(const std::string& InContainerPath, const TMap<FGuid, FAESKey>& InDecryptionKeys);
+
+    // Same as above but with a TOC that was already parsed, the directory index is loaded on first use
+    FIoStatus Initialize(const std::string& InContainerPath, FIoStoreTocResource&& InTocResource, const TMap<FGuid, FAESKey>& InDecryptionKeys);
+
     FIoContainerId GetContainerId() const;
     uint32_t GetVersion() const;
     EIoContainerFlags GetContainerFlags() const;
@@ -48,6 +94,14 @@ public:
     // Reads the chunk off the disk, decryption/decompressing as necessary.
     TIoStatusOr<FIoBuffer> Read(const FIoChunkId& Chunk, const FIoReadOptions& Options) const;
 
+    // As Read(), except the data is decoded straight into Destination, which has to fit the requested range.
+    // Returns the number of bytes written.
+    TIoStatusOr<uint64_t> Read(const FIoChunkId& Chunk, const FIoReadOptions& Options, std::span<uint8_t> Destination) const;
+
+    // Reads several whole chunks at once, results are in the same order as Chunks. Blocks shared between chunks
+    // are read and decoded once, and neighbouring blocks are merged into larger reads in container order.
+    std::vector<TIoStatusOr<FIoBuffer>> ReadBatch(std::span<const FIoChunkId> Chunks) const;
+
     // As Read(), except returns a task that will contain the result after a .wait/.get.
     std::future<TIoStatusOr<FIoBuffer>> ReadAsync(const FIoChunkId& Chunk, const FIoReadOptions& Options) const;
 
@@ -59,6 +113,9 @@ public:
 
     const FIoDirectoryIndexReader& GetDirectoryIndexReader() const;
 
+    // TOC entry index of one file, found by walking the directory index instead of flattening it into every path
+    std::optional<uint32_t> FindTocEntryIndex(std::string_view Path) const;
+
     // TMap<{xxhashed file path}, TocEntryIndex>
     void GetFiles(TMap<uint64_t, uint32_t>& OutFileList) const;
     void GetFiles(std::vector<std::pair<std::string, uint32_t>>& OutFileList) const;
@@ -70,8 +127,58 @@ public:
     void EnumerateCompressedBlocks(std::function<bool(const FIoStoreTocCompressedBlockInfo&)>&& Callback) const;
     void EnumerateCompressedBlocksForChunk(const FIoChunkId& Chunk, std::function<bool(const FIoStoreTocCompressedBlockInfo&)>&& Callback) const;
 
+    // Reads and decodes the chunks' blocks into the block cache in the background without blocking. Demand reads
+    // always run first. Pass an existing request to track several prefetches together.
+    TSharedPtr<FIoPrefetchRequest> Prefetch(std::span<const FIoChunkId> Chunks, TSharedPtr<FIoPrefetchRequest> Request = nullptr) const;
+
+    // Decodes chunks on every worker and checks them against the blake3 hashes in the TOC's chunk metas. Goes
+    // around the block cache so it sees what is on disk. Fails for containers older than IoHash chunk metas.
+    TIoStatusOr<FIoVerifyResult> Verify(const FIoVerifyOptions& Options = {}) const;
+
+    // Hints for how the container files are about to be read, e.g. Sequential for bulk scans
+    void AdviseAccessPattern(EFileAccessPattern Pattern) const;
+
+    // Starts loading the chunk's blocks from disk in the background, they aren't decoded or cached
+    void AdviseWillNeed(const FIoChunkId& Chunk) const;
+
     // Returns the .ucas file path and all partition(s) ({containername}_s1.ucas, {containername}_s2.ucas)
     void GetContainerFilePaths(std::vector<std::string>& OutPaths);
 private:
+    friend class FIoChunkArchive;
+
     class FIoStoreReaderImpl* Impl;
+};
+
+// Reads a single chunk without decoding all of it up front. Compression blocks are decoded as the
+// cursor reaches them and the last few are kept around, so inspecting a header or skipping through
+// bulk data only pays for the blocks it touches. The reader has to outlive the archive.
+export class FIoChunkArchive : public FArchive {
+public:
+    static constexpr uint32_t DecodedBlockCount = 4;
+
+    FIoChunkArchive(const FIoStoreReader& Reader, const FIoChunkId& InChunkId);
+
+    bool IsValid() const { return Impl != nullptr; }
+
+    bool Serialize(void* V, int64_t Length) override;
+    void Seek(int64_t InPos) override { Position = InPos; }
+    int64_t Tell() override { return Position; }
+    int64_t TotalSize() override { return ChunkSize; }
+private:
+    struct FDecodedBlock {
+        int32_t BlockIndex = -1;
+        FIoBlockCache::FBlockRef Block;
+    };
+
+    const FIoBlockCache::FBlockRef& GetBlock(int32_t BlockIndex);
+
+    const class FIoStoreReaderImpl* Impl = nullptr;
+    FIoChunkId ChunkId;
+    uint64_t ChunkOffset = 0;
+    uint64_t CompressionBlockSize = 0;
+    int64_t ChunkSize = 0;
+    int64_t Position = 0;
+
+    std::array<FDecodedBlock, DecodedBlockCount> DecodedBlocks;
+    uint32_t NextDecodedBlock = 0;
 };
\ No newline at end of file
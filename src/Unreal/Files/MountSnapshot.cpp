@@ -0,0 +1,333 @@
+#include "Saturn/Defines.h"
+#include "Saturn/Log.h"
+
+#include <xxhash/xxhash.h>
+
+import Saturn.Files.MountSnapshot;
+
+import <mutex>;
+import <string>;
+import <vector>;
+import <cstdint>;
+import <cstring>;
+import <fstream>;
+import <algorithm>;
+import <optional>;
+import <filesystem>;
+import <type_traits>;
+
+import Saturn.Core.IoStatus;
+import Saturn.VFS.FileSystem;
+import Saturn.Readers.FileReaderNoWrite;
+import Saturn.Structs.IoStoreTocHeader;
+import Saturn.Structs.IoStoreTocResource;
+import Saturn.Structs.IoStoreTocCompressedBlockEntry;
+
+template <typename T>
+static void WriteValue(std::vector<uint8_t>& Out, const T& Value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const uint8_t* Bytes = reinterpret_cast<const uint8_t*>(&Value);
+    Out.insert(Out.end(), Bytes, Bytes + sizeof(T));
+}
+
+template <typename T>
+static void WriteArray(std::vector<uint8_t>& Out, const std::vector<T>& Array) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    WriteValue(Out, static_cast<uint32_t>(Array.size()));
+    const uint8_t* Bytes = reinterpret_cast<const uint8_t*>(Array.data());
+    Out.insert(Out.end(), Bytes, Bytes + Array.size() * sizeof(T));
+}
+
+static void WriteString(std::vector<uint8_t>& Out, const std::string& String) {
+    WriteValue(Out, static_cast<uint32_t>(String.size()));
+    Out.insert(Out.end(), String.begin(), String.end());
+}
+
+template <typename T>
+static bool ReadValue(FFileReaderNoWrite& Ar, T& Value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return Ar.Serialize(&Value, sizeof(T));
+}
+
+// Counts come from disk, so they're checked against what is left of the file before allocating
+template <typename T>
+static bool ReadArray(FFileReaderNoWrite& Ar, std::vector<T>& Array) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    uint32_t Num;
+    if (!ReadValue(Ar, Num) || Num > static_cast<uint64_t>(Ar.TotalSize() - Ar.Tell()) / sizeof(T)) {
+        return false;
+    }
+
+    Array.resize(Num);
+    return Num == 0 || Ar.Serialize(Array.data(), Num * sizeof(T));
+}
+
+static bool ReadString(FFileReaderNoWrite& Ar, std::string& String) {
+    uint32_t Num;
+    if (!ReadValue(Ar, Num) || Num > static_cast<uint64_t>(Ar.TotalSize() - Ar.Tell())) {
+        return false;
+    }
+
+    String.resize(Num);
+    return Num == 0 || Ar.Serialize(String.data(), Num);
+}
+
+// Hashes everything from the current position to the end of the file and seeks back, so a torn or
+// corrupted snapshot is caught before any of it is parsed
+static bool HashRemaining(FFileReaderNoWrite& Ar, uint64_t& OutHash) {
+    XXH3_state_t* State = XXH3_createState();
+    struct FFreeState {
+        XXH3_state_t* State;
+        ~FFreeState() { XXH3_freeState(State); }
+    } FreeState { State };
+
+    if (!State || XXH3_64bits_reset(State) != XXH_OK) {
+        return false;
+    }
+
+    const int64_t Start = Ar.Tell();
+    std::vector<uint8_t> Buffer(1024 * 1024);
+    for (int64_t Remaining = Ar.TotalSize() - Start; Remaining > 0;) {
+        const int64_t ChunkSize = std::min<int64_t>(Remaining, Buffer.size());
+        if (!Ar.Serialize(Buffer.data(), ChunkSize)) {
+            return false;
+        }
+        XXH3_64bits_update(State, Buffer.data(), ChunkSize);
+        Remaining -= ChunkSize;
+    }
+
+    OutHash = XXH3_64bits_digest(State);
+    Ar.Seek(Start);
+    return true;
+}
+
+// The TOC tables are used as-is by the reader, so whatever it indexes with has to be in range
+static bool IsTocConsistent(const FIoStoreTocResource& Toc) {
+    if (Toc.Header.TocEntryCount != Toc.ChunkIds.size()
+        || Toc.ChunkOffsetAndLengths.size() != Toc.ChunkIds.size()
+        || Toc.ChunkMetas.size() != Toc.ChunkIds.size()
+        || Toc.Header.TocCompressedBlockEntryCount != Toc.CompressionBlocks.size()) {
+        return false;
+    }
+
+    for (int32_t ChunkIndex : Toc.ChunkIndicesWithoutPerfectHash) {
+        if (ChunkIndex < 0 || static_cast<uint32_t>(ChunkIndex) >= Toc.ChunkIds.size()) {
+            return false;
+        }
+    }
+
+    for (const FIoStoreTocCompressedBlockEntry& Block : Toc.CompressionBlocks) {
+        if (Block.GetCompressionMethodIndex() >= Toc.CompressionMethods.size()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::optional<FContainerFileStamp> FContainerFileStamp::FromContainer(const std::string& ContainerPath) {
+    std::string TocFilePath = ContainerPath + ".utoc";
+
+    std::error_code Code;
+    auto WriteTime = std::filesystem::last_write_time(TocFilePath, Code);
+    if (Code) {
+        return std::nullopt;
+    }
+
+    FFileReaderNoWrite TocFile(TocFilePath.c_str());
+    FIoStoreTocHeader Header;
+    if (!TocFile.IsValid() || !TocFile.Serialize(&Header, sizeof(FIoStoreTocHeader))) {
+        return std::nullopt;
+    }
+
+    FContainerFileStamp Stamp;
+    Stamp.TocSize = static_cast<uint64_t>(TocFile.TotalSize());
+    Stamp.TocWriteTime = static_cast<int64_t>(WriteTime.time_since_epoch().count());
+    Stamp.TocHeaderHash = XXH3_64bits(&Header, sizeof(FIoStoreTocHeader));
+    return Stamp;
+}
+
+FIoStatus FMountSnapshot::Load(const std::string& Path) {
+    FFileReaderNoWrite Ar(Path.c_str());
+    if (!Ar.IsValid()) {
+        return FIoStatusBuilder(EIoErrorCode::FileOpenFailed) << "Failed to open mount snapshot '" << Path << "'";
+    }
+
+    uint32_t FileMagic, FileVersion, ContainerCount;
+    if (!ReadValue(Ar, FileMagic) || FileMagic != Magic) {
+        return FIoStatusBuilder(EIoErrorCode::ReadError) << "Mount snapshot magic mismatch while reading '" << Path << "'";
+    }
+    if (!ReadValue(Ar, FileVersion) || FileVersion != Version) {
+        return FIoStatusBuilder(EIoErrorCode::ReadError) << "Mount snapshot version mismatch while reading '" << Path << "'";
+    }
+
+    uint64_t BodyHash, ActualBodyHash;
+    if (!ReadValue(Ar, BodyHash) || !HashRemaining(Ar, ActualBodyHash) || BodyHash != ActualBodyHash) {
+        return FIoStatusBuilder(EIoErrorCode::ReadError) << "Mount snapshot hash mismatch while reading '" << Path << "'";
+    }
+
+    // Extension ids are only meaningful within the process that made them, so map them onto ours
+    uint32_t ExtensionCount;
+    if (!ReadValue(Ar, ExtensionCount) || ExtensionCount > UINT16_MAX) {
+        return FIoStatusBuilder(EIoErrorCode::ReadError) << "Corrupt extension table in mount snapshot '" << Path << "'";
+    }
+
+    std::vector<uint16_t> ExtensionRemap(ExtensionCount);
+    for (uint32_t i = 0; i < ExtensionCount; i++) {
+        std::string Extension;
+        if (!ReadString(Ar, Extension)) {
+            return FIoStatusBuilder(EIoErrorCode::ReadError) << "Corrupt extension table in mount snapshot '" << Path << "'";
+        }
+        const uint32_t ExtensionId = ExtensionPool::GetOrAdd(Extension);
+        if (ExtensionId == ExtensionPool::InvalidId) {
+            return FIoStatusBuilder(EIoErrorCode::ReadError) << "Mount snapshot '" << Path << "' has more extensions than the extension pool holds";
+        }
+        ExtensionRemap[i] = static_cast<uint16_t>(ExtensionId);
+    }
+
+    if (!ReadValue(Ar, ContainerCount)) {
+        return FIoStatusBuilder(EIoErrorCode::ReadError) << "Truncated mount snapshot '" << Path << "'";
+    }
+
+    TMap<std::string, FContainerSnapshot> LoadedContainers;
+    for (uint32_t ContainerIndex = 0; ContainerIndex < ContainerCount; ContainerIndex++) {
+        std::string ContainerPath;
+        FContainerSnapshot Snapshot;
+        FIoStoreTocResource& Toc = Snapshot.TocResource;
+
+        uint32_t CompressionMethodCount = 0;
+        bool bRead = ReadString(Ar, ContainerPath)
+            && ReadValue(Ar, Snapshot.Stamp)
+            && ReadValue(Ar, Toc.Header)
+            && ReadArray(Ar, Toc.ChunkIds)
+            && ReadArray(Ar, Toc.ChunkOffsetAndLengths)
+            && ReadArray(Ar, Toc.ChunkPerfectHashSeeds)
+            && ReadArray(Ar, Toc.ChunkIndicesWithoutPerfectHash)
+            && ReadArray(Ar, Toc.CompressionBlocks)
+            && ReadValue(Ar, CompressionMethodCount);
+
+        for (uint32_t i = 0; bRead && i < CompressionMethodCount; i++) {
+            bRead = ReadString(Ar, Toc.CompressionMethods.emplace_back());
+        }
+
+        bRead = bRead
+            && ReadValue(Ar, Toc.SignatureHash)
+            && ReadArray(Ar, Toc.ChunkBlockSignatures)
+            && ReadArray(Ar, Toc.DirectoryIndexBuffer)
+            && ReadArray(Ar, Toc.ChunkMetas)
+            && ReadArray(Ar, Toc.TocSignature)
+            && ReadArray(Ar, Toc.BlockSignature)
+            && ReadArray(Ar, Snapshot.Files);
+
+        if (!bRead || !IsTocConsistent(Toc)) {
+            return FIoStatusBuilder(EIoErrorCode::ReadError) << "Corrupt container entry in mount snapshot '" << Path << "'";
+        }
+
+        for (FHashedGameFile& File : Snapshot.Files) {
+            if (File.ExtensionId >= ExtensionCount || File.TocEntryIndex >= Toc.ChunkIds.size()) {
+                return FIoStatusBuilder(EIoErrorCode::ReadError) << "Corrupt file table in mount snapshot '" << Path << "'";
+            }
+            File.ExtensionId = ExtensionRemap[File.ExtensionId];
+        }
+
+        Toc.TocPath = ContainerPath + ".utoc";
+        LoadedContainers.insert_or_assign(std::move(ContainerPath), std::move(Snapshot));
+    }
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Containers = std::move(LoadedContainers);
+    bHadStaleContainers = false;
+    return FIoStatus::Ok;
+}
+
+std::optional<FContainerSnapshot> FMountSnapshot::Take(const std::string& ContainerPath, const FContainerFileStamp& Stamp) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+
+    auto It = Containers.find(ContainerPath);
+    if (It == Containers.end()) {
+        return std::nullopt;
+    }
+
+    std::optional<FContainerSnapshot> Snapshot;
+    if (It->second.Stamp == Stamp) {
+        Snapshot = std::move(It->second);
+    }
+    else {
+        bHadStaleContainers = true;
+    }
+
+    Containers.erase(It);
+    return Snapshot;
+}
+
+bool FMountSnapshot::IsOutdated() {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    return bHadStaleContainers || !Containers.empty();
+}
+
+FIoStatus FMountSnapshot::Save(const std::string& Path, const std::vector<FContainerSnapshotSource>& Containers) {
+    std::vector<uint8_t> Out;
+    WriteValue(Out, Magic);
+    WriteValue(Out, Version);
+
+    // Filled in with the hash of everything after it once the body is written
+    const size_t BodyHashOffset = Out.size();
+    WriteValue(Out, uint64_t(0));
+
+    const uint32_t ExtensionCount = ExtensionPool::Num();
+    WriteValue(Out, ExtensionCount);
+    for (uint32_t i = 0; i < ExtensionCount; i++) {
+        WriteString(Out, ExtensionPool::Get(i));
+    }
+
+    WriteValue(Out, static_cast<uint32_t>(Containers.size()));
+    for (const FContainerSnapshotSource& Container : Containers) {
+        const FIoStoreTocResource& Toc = *Container.TocResource;
+
+        WriteString(Out, Container.ContainerPath);
+        WriteValue(Out, Container.Stamp);
+        WriteValue(Out, Toc.Header);
+        WriteArray(Out, Toc.ChunkIds);
+        WriteArray(Out, Toc.ChunkOffsetAndLengths);
+        WriteArray(Out, Toc.ChunkPerfectHashSeeds);
+        WriteArray(Out, Toc.ChunkIndicesWithoutPerfectHash);
+        WriteArray(Out, Toc.CompressionBlocks);
+
+        WriteValue(Out, static_cast<uint32_t>(Toc.CompressionMethods.size()));
+        for (const std::string& Method : Toc.CompressionMethods) {
+            WriteString(Out, Method);
+        }
+
+        WriteValue(Out, Toc.SignatureHash);
+        WriteArray(Out, Toc.ChunkBlockSignatures);
+        WriteArray(Out, Toc.DirectoryIndexBuffer);
+        WriteArray(Out, Toc.ChunkMetas);
+        WriteArray(Out, Toc.TocSignature);
+        WriteArray(Out, Toc.BlockSignature);
+        WriteArray(Out, Container.Files);
+    }
+
+    const size_t BodyOffset = BodyHashOffset + sizeof(uint64_t);
+    const uint64_t BodyHash = XXH3_64bits(Out.data() + BodyOffset, Out.size() - BodyOffset);
+    std::memcpy(Out.data() + BodyHashOffset, &BodyHash, sizeof(uint64_t));
+
+    // Written next to the old snapshot and swapped in, so a crash mid-write never leaves a torn file behind
+    std::string TempPath = Path + ".tmp";
+    {
+        std::ofstream File(TempPath, std::ios::binary | std::ios::trunc);
+        File.write(reinterpret_cast<const char*>(Out.data()), Out.size());
+        File.close();
+        if (!File) {
+            return FIoStatusBuilder(EIoErrorCode::WriteError) << "Failed to write mount snapshot '" << TempPath << "'";
+        }
+    }
+
+    std::error_code Code;
+    std::filesystem::rename(TempPath, Path, Code);
+    if (Code) {
+        std::filesystem::remove(TempPath, Code);
+        return FIoStatusBuilder(EIoErrorCode::WriteError) << "Failed to replace mount snapshot '" << Path << "'";
+    }
+
+    return FIoStatus::Ok;
+}
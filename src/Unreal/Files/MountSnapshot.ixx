@@ -0,0 +1,65 @@
+module;
+
+#include "Saturn/Defines.h"
+
+export module Saturn.Files.MountSnapshot;
+
+import <mutex>;
+import <string>;
+import <vector>;
+import <cstdint>;
+import <optional>;
+
+import Saturn.Core.IoStatus;
+import Saturn.VFS.FileSystem;
+import Saturn.Structs.IoStoreTocResource;
+
+// Identifies the exact .utoc a snapshot entry was built from, any change to the file invalidates the entry
+export struct FContainerFileStamp {
+    uint64_t TocSize = 0;
+    int64_t TocWriteTime = 0;
+    uint64_t TocHeaderHash = 0;
+
+    bool operator==(const FContainerFileStamp& Other) const = default;
+
+    static std::optional<FContainerFileStamp> FromContainer(const std::string& ContainerPath);
+};
+
+// Everything a mount needs from one container without touching its .utoc
+export struct FContainerSnapshot {
+    FContainerFileStamp Stamp;
+    FIoStoreTocResource TocResource;
+    std::vector<FHashedGameFile> Files;
+};
+
+// One mounted container as handed to FMountSnapshot::Save, the TOC stays owned by its reader
+export struct FContainerSnapshotSource {
+    std::string ContainerPath;
+    FContainerFileStamp Stamp;
+    const FIoStoreTocResource* TocResource = nullptr;
+    std::vector<FHashedGameFile> Files;
+};
+
+// Parsed TOC tables and hashed VFS entries of every container from the last mount, so a warm start
+// skips reading the .utoc files and walking their directory indices. Entries whose container changed
+// on disk are dropped and the container goes through a full parse instead.
+export class FMountSnapshot {
+public:
+    static constexpr uint32_t Magic = 0x544E4D53; // "SMNT"
+    static constexpr uint32_t Version = 2;
+
+    // Fails on anything that doesn't hash or check out, the caller then does a full parse of every container
+    FIoStatus Load(const std::string& Path);
+
+    // Hands out the snapshot of a container if its stamp still matches, every container can be taken once
+    std::optional<FContainerSnapshot> Take(const std::string& ContainerPath, const FContainerFileStamp& Stamp);
+
+    // True once a container was stale or if some were never taken, e.g. because they were removed
+    bool IsOutdated();
+
+    static FIoStatus Save(const std::string& Path, const std::vector<FContainerSnapshotSource>& Containers);
+private:
+    std::mutex Mutex;
+    TMap<std::string, FContainerSnapshot> Containers;
+    bool bHadStaleContainers = false;
+};
@@ -0,0 +1,176 @@
+#include "Saturn/Defines.h"
+
+import Saturn.Files.PackageCache;
+
+import <list>;
+import <mutex>;
+import <future>;
+import <exception>;
+import <functional>;
+
+import Saturn.Files.PackageId;
+import Saturn.Readers.ZenPackageReader;
+
+UPackagePtr FPackageCache::Find(FPackageId PackageId) {
+    std::lock_guard<std::mutex> ScopeLock(Lock);
+    return FindLocked(PackageId);
+}
+
+UPackagePtr FPackageCache::FindLocked(FPackageId PackageId) {
+    auto PinnedIt = PinnedLookup.find(PackageId);
+    if (PinnedIt != PinnedLookup.end()) {
+        Pinned.splice(Pinned.begin(), Pinned, PinnedIt->second);
+        return UPackagePtr(PinnedIt->second->second);
+    }
+
+    auto It = Packages.find(PackageId);
+    if (It == Packages.end()) {
+        return nullptr;
+    }
+
+    TSharedPtr<UPackage> Package = It->second.lock();
+    if (!Package) {
+        Packages.erase(It);
+        return nullptr;
+    }
+
+    // Still alive somewhere, promote it back into the pinned set
+    PinLocked(PackageId, Package);
+    return UPackagePtr(Package);
+}
+
+void FPackageCache::PinLocked(FPackageId PackageId, const TSharedPtr<UPackage>& Package) {
+    if (PinnedCapacity == 0) {
+        return;
+    }
+
+    auto It = PinnedLookup.find(PackageId);
+    if (It != PinnedLookup.end()) {
+        It->second->second = Package;
+        Pinned.splice(Pinned.begin(), Pinned, It->second);
+        return;
+    }
+
+    Pinned.emplace_front(PackageId, Package);
+    PinnedLookup.insert({ PackageId, Pinned.begin() });
+
+    while (Pinned.size() > PinnedCapacity) {
+        UnpinOldestLocked();
+    }
+}
+
+void FPackageCache::UnpinOldestLocked() {
+    const FPackageId PackageId = Pinned.back().first;
+    PinnedLookup.erase(PackageId);
+    Pinned.pop_back();
+
+    // Unpinned packages stay reachable through the weak map while anyone still holds them
+    auto It = Packages.find(PackageId);
+    if (It != Packages.end() && It->second.expired()) {
+        Packages.erase(It);
+    }
+}
+
+UPackagePtr FPackageCache::FindOrLoad(FPackageId PackageId, const std::function<UPackagePtr()>& Loader) {
+    std::promise<UPackagePtr> Promise;
+    std::shared_future<UPackagePtr> PendingLoad;
+    uint64_t LoadGeneration = 0;
+    {
+        std::lock_guard<std::mutex> ScopeLock(Lock);
+        if (UPackagePtr Package = FindLocked(PackageId)) {
+            Hits++;
+            return Package;
+        }
+
+        auto It = InFlight.find(PackageId);
+        if (It != InFlight.end()) {
+            JoinedLoads++;
+            PendingLoad = It->second.Result;
+        }
+        else {
+            Misses++;
+            LoadGeneration = Generation;
+            InFlight.insert({ PackageId, FInFlightLoad { Promise.get_future().share(), LoadGeneration } });
+        }
+    }
+
+    if (PendingLoad.valid()) {
+        return PendingLoad.get();
+    }
+
+    // Remove and Clear drop in-flight entries, so a newer load for the same package may own the slot by now
+    auto FinishInFlightLocked = [this, PackageId, LoadGeneration]() {
+        auto It = InFlight.find(PackageId);
+        if (It != InFlight.end() && It->second.Generation == LoadGeneration) {
+            InFlight.erase(It);
+        }
+    };
+
+    UPackagePtr Package;
+    try {
+        Package = Loader();
+    }
+    catch (...) {
+        {
+            std::lock_guard<std::mutex> ScopeLock(Lock);
+            FinishInFlightLocked();
+        }
+        Promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard<std::mutex> ScopeLock(Lock);
+        FinishInFlightLocked();
+        if (Package && Generation == LoadGeneration) {
+            Packages.insert_or_assign(PackageId, TWeakPtr<UPackage>(Package.GetSharedPtr()));
+            PinLocked(PackageId, Package.GetSharedPtr());
+        }
+    }
+
+    Promise.set_value(Package);
+    return Package;
+}
+
+void FPackageCache::Remove(FPackageId PackageId) {
+    std::lock_guard<std::mutex> ScopeLock(Lock);
+
+    Generation++;
+    Packages.erase(PackageId);
+    InFlight.erase(PackageId);
+
+    auto It = PinnedLookup.find(PackageId);
+    if (It != PinnedLookup.end()) {
+        Pinned.erase(It->second);
+        PinnedLookup.erase(It);
+    }
+}
+
+void FPackageCache::Clear() {
+    std::lock_guard<std::mutex> ScopeLock(Lock);
+    Generation++;
+    Packages.clear();
+    PinnedLookup.clear();
+    Pinned.clear();
+    InFlight.clear();
+}
+
+void FPackageCache::SetPinnedCapacity(size_t InPinnedCapacity) {
+    std::lock_guard<std::mutex> ScopeLock(Lock);
+    PinnedCapacity = InPinnedCapacity;
+
+    while (Pinned.size() > PinnedCapacity) {
+        UnpinOldestLocked();
+    }
+}
+
+FPackageCacheStats FPackageCache::GetStats() {
+    std::lock_guard<std::mutex> ScopeLock(Lock);
+
+    FPackageCacheStats Stats;
+    Stats.Hits = Hits;
+    Stats.Misses = Misses;
+    Stats.JoinedLoads = JoinedLoads;
+    Stats.PinnedCount = Pinned.size();
+    return Stats;
+}
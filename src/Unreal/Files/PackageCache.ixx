@@ -0,0 +1,69 @@
+module;
+
+#include "Saturn/Defines.h"
+
+export module Saturn.Files.PackageCache;
+
+import <list>;
+import <mutex>;
+import <future>;
+import <cstdint>;
+import <functional>;
+
+import Saturn.Files.PackageId;
+import Saturn.Readers.ZenPackageReader;
+
+export struct FPackageCacheStats {
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t JoinedLoads = 0;
+    uint64_t PinnedCount = 0;
+};
+
+// Loaded packages keyed by FPackageId. Every package is tracked weakly for as long as someone still
+// holds it, and the most recently used ones are also pinned so they survive between unrelated loads.
+// Concurrent requests for a package that is still loading wait on that load instead of starting another.
+// Every caller asking for the same package gets the same UPackage, so cached packages must be treated as
+// read-only. Anything that changes the underlying data (patching a container, unmounting) has to Remove or
+// Clear, which also keeps loads that were already running from putting their stale result back.
+export class FPackageCache {
+public:
+    static constexpr size_t DefaultPinnedCapacity = 64;
+
+    explicit FPackageCache(size_t InPinnedCapacity = DefaultPinnedCapacity) : PinnedCapacity(InPinnedCapacity) {}
+
+    UPackagePtr Find(FPackageId PackageId);
+
+    // Returns the cached package, or runs Loader once and caches its result. Failed loads (nullptr) aren't cached,
+    // and neither are loads that were still running when Remove or Clear was called.
+    UPackagePtr FindOrLoad(FPackageId PackageId, const std::function<UPackagePtr()>& Loader);
+
+    void Remove(FPackageId PackageId);
+    void Clear();
+
+    void SetPinnedCapacity(size_t InPinnedCapacity);
+    FPackageCacheStats GetStats();
+private:
+    UPackagePtr FindLocked(FPackageId PackageId);
+    void PinLocked(FPackageId PackageId, const TSharedPtr<UPackage>& Package);
+    void UnpinOldestLocked();
+
+    using FPinnedList = std::list<std::pair<FPackageId, TSharedPtr<UPackage>>>;
+
+    struct FInFlightLoad {
+        std::shared_future<UPackagePtr> Result;
+        uint64_t Generation;
+    };
+
+    std::mutex Lock;
+    TMap<FPackageId, TWeakPtr<UPackage>> Packages;
+    FPinnedList Pinned; // front is most recently used
+    TMap<FPackageId, FPinnedList::iterator> PinnedLookup;
+    TMap<FPackageId, FInFlightLoad> InFlight;
+    size_t PinnedCapacity;
+    uint64_t Generation = 0; // bumped by Remove and Clear
+
+    uint64_t Hits = 0;
+    uint64_t Misses = 0;
+    uint64_t JoinedLoads = 0;
+};
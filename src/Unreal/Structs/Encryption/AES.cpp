@@ -1,5 +1,18 @@
 #include <sstream>
 #include <iomanip>
+#include <cstring>
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC exposes every intrinsic regardless of /arch, so no per-function target is needed
+#define AES_TARGET_AESNI
+#define AES_TARGET_VAES
+#else
+#include <cpuid.h>
+#define AES_TARGET_AESNI __attribute__((target("sse2,aes")))
+#define AES_TARGET_VAES __attribute__((target("sse2,aes,avx2,vaes")))
+#endif
 
 import Saturn.Encryption.AES;
 
@@ -274,20 +287,262 @@ static inline void AesDecryptExpand(FAesExpandedKey* DecryptKey, const uint8_t*
 	DKey[3] = EKey[3];
 }
 
+#define AES_DEC(a, b, c, d) (       \
+	AesITbox[0][(uint8_t)(a >>  0)] ^ \
+	AesITbox[1][(uint8_t)(b >>  8)] ^ \
+	AesITbox[2][(uint8_t)(c >> 16)] ^ \
+	AesITbox[3][(uint8_t)(d >> 24)]   \
+)
+
+#define AES_DEC_LAST(a, b, c, d) (       \
+	(AesISbox[(uint8_t)(a >>  0)] <<  0) ^ \
+	(AesISbox[(uint8_t)(b >>  8)] <<  8) ^ \
+	(AesISbox[(uint8_t)(c >> 16)] << 16) ^ \
+	(AesISbox[(uint8_t)(d >> 24)] << 24)   \
+)
+
+// Portable T-table decryptor. Always available, and used as the reference for the hardware paths.
+static void AesDecryptBlocksTable(const uint32_t* DKey, uint8_t* Contents, size_t NumBlocks)
+{
+	for (size_t BlockIndex = 0; BlockIndex < NumBlocks; BlockIndex++)
+	{
+		auto Block = Contents + BlockIndex * 16;
+
+		uint32_t s0 = *(uint32_t*)(Block + 0) ^ DKey[0];
+		uint32_t s1 = *(uint32_t*)(Block + 4) ^ DKey[1];
+		uint32_t s2 = *(uint32_t*)(Block + 8) ^ DKey[2];
+		uint32_t s3 = *(uint32_t*)(Block + 12) ^ DKey[3];
+
+		for (int Round = 1; Round < AES256_ROUND_COUNT; Round++)
+		{
+			uint32_t t0 = AES_DEC(s0, s3, s2, s1);
+			uint32_t t1 = AES_DEC(s1, s0, s3, s2);
+			uint32_t t2 = AES_DEC(s2, s1, s0, s3);
+			uint32_t t3 = AES_DEC(s3, s2, s1, s0);
+
+			s0 = t0 ^ DKey[4 * Round + 0];
+			s1 = t1 ^ DKey[4 * Round + 1];
+			s2 = t2 ^ DKey[4 * Round + 2];
+			s3 = t3 ^ DKey[4 * Round + 3];
+		}
+
+		uint32_t t0 = AES_DEC_LAST(s0, s3, s2, s1);
+		uint32_t t1 = AES_DEC_LAST(s1, s0, s3, s2);
+		uint32_t t2 = AES_DEC_LAST(s2, s1, s0, s3);
+		uint32_t t3 = AES_DEC_LAST(s3, s2, s1, s0);
+
+		s0 = t0 ^ DKey[4 * AES256_ROUND_COUNT + 0];
+		s1 = t1 ^ DKey[4 * AES256_ROUND_COUNT + 1];
+		s2 = t2 ^ DKey[4 * AES256_ROUND_COUNT + 2];
+		s3 = t3 ^ DKey[4 * AES256_ROUND_COUNT + 3];
+
+		*(uint32_t*)(Block + 0) = s0;
+		*(uint32_t*)(Block + 4) = s1;
+		*(uint32_t*)(Block + 8) = s2;
+		*(uint32_t*)(Block + 12) = s3;
+	}
+}
+
+#undef AES_DEC
+#undef AES_DEC_LAST
+
+// The decrypt schedule built by AesDecryptExpand is the "equivalent inverse cipher" one (round keys
+// reversed, InvMixColumns applied to the middle rounds), stored in block byte order. That is exactly
+// what AESDEC/AESDECLAST expect, so the hardware paths below load it as-is.
+#define AES_PARALLEL_BLOCKS 8
+
+AES_TARGET_AESNI
+static void AesDecryptBlocksAesNi(const uint32_t* DKey, uint8_t* Contents, size_t NumBlocks)
+{
+	__m128i RoundKeys[AES256_ROUND_COUNT + 1];
+	for (int Round = 0; Round <= AES256_ROUND_COUNT; Round++)
+	{
+		RoundKeys[Round] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(DKey) + Round);
+	}
+
+	auto Blocks = reinterpret_cast<__m128i*>(Contents);
+	size_t BlockIndex = 0;
+
+	// AESDEC has a latency of several cycles but a throughput of one per cycle, so keep
+	// several independent blocks in flight per round.
+	for (; BlockIndex + AES_PARALLEL_BLOCKS <= NumBlocks; BlockIndex += AES_PARALLEL_BLOCKS)
+	{
+		__m128i State[AES_PARALLEL_BLOCKS];
+		for (int Lane = 0; Lane < AES_PARALLEL_BLOCKS; Lane++)
+		{
+			State[Lane] = _mm_xor_si128(_mm_loadu_si128(Blocks + BlockIndex + Lane), RoundKeys[0]);
+		}
+
+		for (int Round = 1; Round < AES256_ROUND_COUNT; Round++)
+		{
+			for (int Lane = 0; Lane < AES_PARALLEL_BLOCKS; Lane++)
+			{
+				State[Lane] = _mm_aesdec_si128(State[Lane], RoundKeys[Round]);
+			}
+		}
+
+		for (int Lane = 0; Lane < AES_PARALLEL_BLOCKS; Lane++)
+		{
+			_mm_storeu_si128(Blocks + BlockIndex + Lane, _mm_aesdeclast_si128(State[Lane], RoundKeys[AES256_ROUND_COUNT]));
+		}
+	}
+
+	for (; BlockIndex < NumBlocks; BlockIndex++)
+	{
+		__m128i State = _mm_xor_si128(_mm_loadu_si128(Blocks + BlockIndex), RoundKeys[0]);
+		for (int Round = 1; Round < AES256_ROUND_COUNT; Round++)
+		{
+			State = _mm_aesdec_si128(State, RoundKeys[Round]);
+		}
+		_mm_storeu_si128(Blocks + BlockIndex, _mm_aesdeclast_si128(State, RoundKeys[AES256_ROUND_COUNT]));
+	}
+}
+
+AES_TARGET_VAES
+static void AesDecryptBlocksVaes(const uint32_t* DKey, uint8_t* Contents, size_t NumBlocks)
+{
+	constexpr int Lanes = AES_PARALLEL_BLOCKS / 2; // two blocks per ymm register
+
+	__m256i RoundKeys[AES256_ROUND_COUNT + 1];
+	for (int Round = 0; Round <= AES256_ROUND_COUNT; Round++)
+	{
+		RoundKeys[Round] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(DKey) + Round));
+	}
+
+	auto Blocks = reinterpret_cast<__m256i*>(Contents);
+	size_t BlockIndex = 0;
+
+	for (; BlockIndex + AES_PARALLEL_BLOCKS <= NumBlocks; BlockIndex += AES_PARALLEL_BLOCKS)
+	{
+		__m256i* Source = Blocks + BlockIndex / 2;
+
+		__m256i State[Lanes];
+		for (int Lane = 0; Lane < Lanes; Lane++)
+		{
+			State[Lane] = _mm256_xor_si256(_mm256_loadu_si256(Source + Lane), RoundKeys[0]);
+		}
+
+		for (int Round = 1; Round < AES256_ROUND_COUNT; Round++)
+		{
+			for (int Lane = 0; Lane < Lanes; Lane++)
+			{
+				State[Lane] = _mm256_aesdec_epi128(State[Lane], RoundKeys[Round]);
+			}
+		}
+
+		for (int Lane = 0; Lane < Lanes; Lane++)
+		{
+			_mm256_storeu_si256(Source + Lane, _mm256_aesdeclast_epi128(State[Lane], RoundKeys[AES256_ROUND_COUNT]));
+		}
+	}
+
+	// Leftover blocks go through the 128-bit path. Every VAES part also has AES-NI.
+	if (BlockIndex < NumBlocks)
+	{
+		AesDecryptBlocksAesNi(DKey, Contents + BlockIndex * FAESKey::AESBlockSize, NumBlocks - BlockIndex);
+	}
+}
+
+#undef AES_PARALLEL_BLOCKS
+
+static void AesCpuId(int Leaf, int SubLeaf, uint32_t Registers[4])
+{
+#if defined(_MSC_VER)
+	int Info[4];
+	__cpuidex(Info, Leaf, SubLeaf);
+	for (int Index = 0; Index < 4; Index++)
+	{
+		Registers[Index] = static_cast<uint32_t>(Info[Index]);
+	}
+#else
+	__cpuid_count(Leaf, SubLeaf, Registers[0], Registers[1], Registers[2], Registers[3]);
+#endif
+}
+
+static uint64_t AesReadXCR0()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	uint32_t Low, High;
+	__asm__ volatile("xgetbv" : "=a"(Low), "=d"(High) : "c"(0));
+	return (uint64_t(High) << 32) | Low;
+#endif
+}
+
+typedef void(*FAesDecryptBlocksFunc)(const uint32_t* DKey, uint8_t* Contents, size_t NumBlocks);
+
+struct FAesDecryptor
+{
+	FAesDecryptBlocksFunc DecryptBlocks;
+	const char* Name;
+};
+
+static FAesDecryptor AesSelectDecryptor()
+{
+	uint32_t Leaf0[4], Leaf1[4];
+	AesCpuId(0, 0, Leaf0);
+	AesCpuId(1, 0, Leaf1);
+
+	const bool bHasAesNi = (Leaf1[2] & (1u << 25)) != 0;
+	if (!bHasAesNi)
+	{
+		return { AesDecryptBlocksTable, "Table" };
+	}
+
+	// VAES needs the OS to preserve ymm state (OSXSAVE + XCR0 SSE/AVX bits) on top of the CPU flags.
+	const bool bHasOsXSave = (Leaf1[2] & (1u << 27)) != 0;
+	const bool bHasAvx = (Leaf1[2] & (1u << 28)) != 0;
+	if (Leaf0[0] >= 7 && bHasOsXSave && bHasAvx && (AesReadXCR0() & 0x6) == 0x6)
+	{
+		uint32_t Leaf7[4];
+		AesCpuId(7, 0, Leaf7);
+
+		const bool bHasAvx2 = (Leaf7[1] & (1u << 5)) != 0;
+		const bool bHasVaes = (Leaf7[2] & (1u << 9)) != 0;
+		if (bHasAvx2 && bHasVaes)
+		{
+			return { AesDecryptBlocksVaes, "VAES" };
+		}
+	}
+
+	return { AesDecryptBlocksAesNi, "AES-NI" };
+}
+
+static const FAesDecryptor& GetAesDecryptor()
+{
+	static const FAesDecryptor Decryptor = AesSelectDecryptor();
+	return Decryptor;
+}
+
 FAESKey::FAESKey()
 {
 	memset(Key, 0, KeySize);
+	ExpandKey();
 }
 
 FAESKey::FAESKey(std::string KeyHexString)
 {
+	memset(Key, 0, KeySize);
+
 	if (KeyHexString.starts_with("0x"))
 		KeyHexString.erase(0, 2);
 
-	for (unsigned int i = 0; i < KeyHexString.length() / 2; i++)
+	for (unsigned int i = 0; i < KeyHexString.length() / 2 && i < KeySize; i++)
 	{
 		Key[i] = static_cast<uint8_t>(strtol(KeyHexString.substr(i * 2, 2).c_str(), NULL, 16));
 	}
+
+	ExpandKey();
+}
+
+void FAESKey::ExpandKey()
+{
+	FAesExpandedKey DecryptKey;
+	AesDecryptExpand(&DecryptKey, this->Key);
+
+	static_assert(sizeof(DecryptRoundKeys) == sizeof(DecryptKey.Key));
+	memcpy(DecryptRoundKeys, DecryptKey.Key, sizeof(DecryptRoundKeys));
 }
 
 bool FAESKey::IsValid() const
@@ -324,60 +579,15 @@ bool FAESKey::operator==(const FAESKey& Other) const
 
 void FAESKey::DecryptData(uint8_t* Contents, uint32_t NumBytes) const
 {
-#define AES_DEC(a, b, c, d) (       \
-	AesITbox[0][(uint8_t)(a >>  0)] ^ \
-	AesITbox[1][(uint8_t)(b >>  8)] ^ \
-	AesITbox[2][(uint8_t)(c >> 16)] ^ \
-	AesITbox[3][(uint8_t)(d >> 24)]   \
-)
-
-#define AES_DEC_LAST(a, b, c, d) (       \
-	(AesISbox[(uint8_t)(a >>  0)] <<  0) ^ \
-	(AesISbox[(uint8_t)(b >>  8)] <<  8) ^ \
-	(AesISbox[(uint8_t)(c >> 16)] << 16) ^ \
-	(AesISbox[(uint8_t)(d >> 24)] << 24)   \
-)
-
-	FAesExpandedKey DecryptKey;
-	AesDecryptExpand(&DecryptKey, this->Key);
-
-	auto DKey = DecryptKey.Key;
-
-	for (uint32_t Offset = 0; Offset < NumBytes; Offset += 16)
-	{
-		auto Block = Contents + Offset;
-
-		uint32_t s0 = *(uint32_t*)(Block + 0) ^ DKey[0];
-		uint32_t s1 = *(uint32_t*)(Block + 4) ^ DKey[1];
-		uint32_t s2 = *(uint32_t*)(Block + 8) ^ DKey[2];
-		uint32_t s3 = *(uint32_t*)(Block + 12) ^ DKey[3];
-
-		for (int Round = 1; Round < AES256_ROUND_COUNT; Round++)
-		{
-			uint32_t t0 = AES_DEC(s0, s3, s2, s1);
-			uint32_t t1 = AES_DEC(s1, s0, s3, s2);
-			uint32_t t2 = AES_DEC(s2, s1, s0, s3);
-			uint32_t t3 = AES_DEC(s3, s2, s1, s0);
-
-			s0 = t0 ^ DKey[4 * Round + 0];
-			s1 = t1 ^ DKey[4 * Round + 1];
-			s2 = t2 ^ DKey[4 * Round + 2];
-			s3 = t3 ^ DKey[4 * Round + 3];
-		}
-
-		uint32_t t0 = AES_DEC_LAST(s0, s3, s2, s1);
-		uint32_t t1 = AES_DEC_LAST(s1, s0, s3, s2);
-		uint32_t t2 = AES_DEC_LAST(s2, s1, s0, s3);
-		uint32_t t3 = AES_DEC_LAST(s3, s2, s1, s0);
+	GetAesDecryptor().DecryptBlocks(DecryptRoundKeys, Contents, NumBytes / AESBlockSize);
+}
 
-		s0 = t0 ^ DKey[4 * AES256_ROUND_COUNT + 0];
-		s1 = t1 ^ DKey[4 * AES256_ROUND_COUNT + 1];
-		s2 = t2 ^ DKey[4 * AES256_ROUND_COUNT + 2];
-		s3 = t3 ^ DKey[4 * AES256_ROUND_COUNT + 3];
+void FAESKey::DecryptDataReference(uint8_t* Contents, uint32_t NumBytes) const
+{
+	AesDecryptBlocksTable(DecryptRoundKeys, Contents, NumBytes / AESBlockSize);
+}
 
-		*(uint32_t*)(Block + 0) = s0;
-		*(uint32_t*)(Block + 4) = s1;
-		*(uint32_t*)(Block + 8) = s2;
-		*(uint32_t*)(Block + 12) = s3;
-	}
-}
\ No newline at end of file
+const char* FAESKey::GetDecryptorName()
+{
+	return GetAesDecryptor().Name;
+}
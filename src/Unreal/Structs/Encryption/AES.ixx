@@ -15,4 +15,16 @@ export struct FAESKey {
 	bool IsValid() const;
 	std::string ToString();
 	void DecryptData(uint8_t* Contents, uint32_t NumBytes) const;
+
+	// Table-based decrypt, bypassing hardware dispatch. Output is identical to DecryptData.
+	void DecryptDataReference(uint8_t* Contents, uint32_t NumBytes) const;
+
+	// Name of the decryptor selected for this CPU ("VAES", "AES-NI" or "Table").
+	static const char* GetDecryptorName();
+private:
+	void ExpandKey();
+
+	// Decryption schedule, computed once per key instead of on every DecryptData call.
+	// The key bytes must not be changed after construction.
+	alignas(16) uint32_t DecryptRoundKeys[4 * 15];
 };
\ No newline at end of file
@@ -9,314 +9,657 @@ import <cstdint>;
 import <string>;
 import <vector>;
 import <mutex>;
+import <array>;
+import <atomic>;
+import <memory>;
+import <cstring>;
 import <future>;
-import <sstream>;
 import <optional>;
+import <algorithm>;
 import <functional>;
-import <filesystem>;
+import <string_view>;
 import <shared_mutex>;
 
 import Saturn.Core.IoStatus;
 import Saturn.Misc.IoBuffer;
 import Saturn.IoStore.IoStoreReader;
+import Saturn.IoStore.IoDirectoryIndex;
+import Saturn.Misc.IoReadOptions;
+import Saturn.Structs.IoStoreTocResource;
 import Saturn.Structs.IoStoreTocChunkInfo;
 
-// Global storage for the extension pool
-uint32_t ExtensionPool::GetOrAdd(const std::string& extension) {
-    auto it = s_Pool.find(extension);
-    if (it != s_Pool.end())
-        return it->second;
+// Open addressing table that is never more than half full. Slots hold id + 1 and are only ever set once, a slot
+// is published after its name is written, so a reader that sees the slot also sees the name.
+class FExtensionTable {
+public:
+    FExtensionTable() {
+        static constexpr std::string_view knownExtensions[] = {
+            "", ".uasset", ".uexp", ".ubulk", ".uptnl", ".umap", ".ushaderbytecode", ".upipelinecache",
+            ".uplugin", ".upluginmanifest", ".uproject", ".ini", ".locres", ".locmeta", ".json", ".bin",
+            ".ufont", ".ttf", ".otf", ".png", ".udic"
+        };
+        for (std::string_view extension : knownExtensions) {
+            Add(extension);
+        }
+    }
+
+    uint32_t Find(std::string_view extension) const {
+        for (uint32_t slot = HashExtension(extension);; slot = (slot + 1) & SlotMask) {
+            uint32_t entry = slots[slot].load(std::memory_order_acquire);
+            if (entry == 0) {
+                return ExtensionPool::InvalidId;
+            }
+            if (names[entry - 1] == extension) {
+                return entry - 1;
+            }
+        }
+    }
+
+    uint32_t GetOrAdd(std::string_view extension) {
+        uint32_t id = Find(extension);
+        if (id != ExtensionPool::InvalidId) {
+            return id;
+        }
+
+        std::lock_guard<std::mutex> lock(addLock);
+        return Add(extension);
+    }
+
+    const std::string& Get(uint32_t id) const {
+        return names[id];
+    }
+
+    uint32_t Num() const {
+        return count.load(std::memory_order_acquire);
+    }
+private:
+    static constexpr uint32_t SlotMask = ExtensionPool::MaxExtensions * 2 - 1;
+
+    static uint32_t HashExtension(std::string_view extension) {
+        return static_cast<uint32_t>(XXH3_64bits(extension.data(), extension.size())) & SlotMask;
+    }
+
+    // Callers serialize adds, finds may run at the same time
+    uint32_t Add(std::string_view extension) {
+        // Another thread may have added it while we waited for the lock
+        uint32_t id = Find(extension);
+        if (id != ExtensionPool::InvalidId) {
+            return id;
+        }
 
-    uint32_t id = static_cast<uint32_t>(s_ReverseLookup.size());
-    s_ReverseLookup.push_back(extension);
-    s_Pool.insert_or_assign(extension, id);
-    return id;
+        id = count.load(std::memory_order_relaxed);
+        if (id == ExtensionPool::MaxExtensions) {
+            LOG_ERROR("Extension pool is full, can't add '{0}'", extension);
+            return ExtensionPool::InvalidId;
+        }
+
+        names[id] = extension;
+        count.store(id + 1, std::memory_order_release);
+
+        uint32_t slot = HashExtension(extension);
+        while (slots[slot].load(std::memory_order_relaxed) != 0) {
+            slot = (slot + 1) & SlotMask;
+        }
+        slots[slot].store(id + 1, std::memory_order_release);
+        return id;
+    }
+
+    std::array<std::string, ExtensionPool::MaxExtensions> names;
+    std::array<std::atomic_uint32_t, ExtensionPool::MaxExtensions * 2> slots {};
+    std::atomic_uint32_t count { 0 };
+    std::mutex addLock;
+};
+
+static FExtensionTable& GetExtensionTable() {
+    static FExtensionTable table;
+    return table;
 }
 
-const std::string& ExtensionPool::Get(uint32_t id) {
-    return s_ReverseLookup[id];
+uint32_t ExtensionPool::GetOrAdd(std::string_view extension) {
+    return GetExtensionTable().GetOrAdd(extension);
 }
 
-void VirtualFileSystem::Register(const std::string& Path, uint32_t TocEntryIndex) {
-    std::unique_lock<std::shared_mutex> lock(s_VFSMutex);
+uint32_t ExtensionPool::Find(std::string_view extension) {
+    return GetExtensionTable().Find(extension);
+}
 
-    std::string pathWithoutExtension = GetPathWithoutExtension(Path);
-    uint64_t hashedPath = XXH3_64bits(pathWithoutExtension.c_str(), pathWithoutExtension.size());
-    uint32_t extensionId = ExtensionPool::GetOrAdd(GetExtension(Path));
+const std::string& ExtensionPool::Get(uint32_t id) {
+    return GetExtensionTable().Get(id);
+}
 
-    auto& file = s_FileMap[hashedPath];
-    file.Extensions.emplace_back(extensionId, TocEntryIndex);
+uint32_t ExtensionPool::Num() {
+    return GetExtensionTable().Num();
 }
 
-void VirtualFileSystem::RegisterBatch(const std::vector<std::pair<std::string, uint32_t>>& Files) {
-    phmap::flat_hash_map<uint64_t, FGameFile> localFileMap;
+void VirtualFileSystem::FFileShard::Add(uint64_t PathHash, const FGameFileEntry& Entry, uint32_t MountOrder) {
+    const uint32_t entryIndex = static_cast<uint32_t>(Entries.size());
+    Entries.push_back(Entry);
+    MountOrders.push_back(MountOrder);
+    NextEntries.push_back(InvalidEntryIndex);
 
-    for (const auto& [Path, TocEntryIndex] : Files) {
-        std::string pathWithoutExtension = GetPathWithoutExtension(Path);
-        uint64_t hashedPath = XXH3_64bits(pathWithoutExtension.c_str(), pathWithoutExtension.size());
-        uint32_t extensionId = ExtensionPool::GetOrAdd(GetExtension(Path));
+    auto [it, bInserted] = FirstEntries.try_emplace(PathHash, entryIndex);
+    if (bInserted) {
+        return;
+    }
 
-        auto& file = localFileMap[hashedPath];
-        file.Extensions.emplace_back(extensionId, TocEntryIndex);
+    // A package has a handful of files at most, so the chain is short enough to walk for the same extension
+    uint32_t* link = &it->second;
+    while (*link != InvalidEntryIndex && Entries[*link].ExtensionId != Entry.ExtensionId) {
+        link = &NextEntries[*link];
     }
 
-    std::unique_lock<std::shared_mutex> lock(s_VFSMutex);
-    for (const auto& [key, localFile] : localFileMap) {
-        auto& globalFile = s_FileMap[key];
-        globalFile.Extensions.insert(
-            globalFile.Extensions.end(),
-            localFile.Extensions.begin(),
-            localFile.Extensions.end()
-        );
+    if (*link == InvalidEntryIndex) {
+        *link = entryIndex;
+        return;
+    }
+
+    // The entry with the higher mount order takes the winner's place in the chain, the other one is shadowed
+    uint32_t shadowedIndex = entryIndex;
+    if (MountOrder > MountOrders[*link]) {
+        shadowedIndex = *link;
+        NextEntries[entryIndex] = NextEntries[shadowedIndex];
+        *link = entryIndex;
     }
+
+    uint32_t& firstShadowed = FirstShadowed.try_emplace(PathHash, InvalidEntryIndex).first->second;
+    NextEntries[shadowedIndex] = firstShadowed;
+    firstShadowed = shadowedIndex;
 }
 
-void VirtualFileSystem::RegisterParallel(const std::vector<std::pair<std::string, uint32_t>>& Files) {
-    const size_t numThreads = std::thread::hardware_concurrency();
+void VirtualFileSystem::Insert(uint64_t PathHash, const FGameFileEntry& Entry, uint32_t MountOrder) {
+    FFileShard& shard = s_FileShards[GetShardIndex(PathHash)];
+    std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+    shard.Add(PathHash, Entry, MountOrder);
+}
+
+void VirtualFileSystem::Insert(const std::string& Path, uint32_t TocEntryIndex, uint16_t ReaderId, uint32_t MountOrder) {
+    // Narrowing InvalidId would register the file under an extension that doesn't exist
+    uint32_t extensionId = ExtensionPool::GetOrAdd(GetExtension(Path));
+    if (extensionId == ExtensionPool::InvalidId) {
+        LOG_WARN("Skipping '{0}', its extension doesn't fit in the extension pool", Path);
+        return;
+    }
+
+    Insert(HashPathWithoutExtension(Path), { ReaderId, static_cast<uint16_t>(extensionId), TocEntryIndex }, MountOrder);
+}
+
+void VirtualFileSystem::Register(const std::string& Path, uint32_t TocEntryIndex, uint16_t ReaderId) {
+    Insert(Path, TocEntryIndex, ReaderId, GetMountOrder(ReaderId));
+}
+
+void VirtualFileSystem::RegisterBatch(const std::vector<std::pair<std::string, uint32_t>>& Files, uint16_t ReaderId) {
+    const uint32_t mountOrder = GetMountOrder(ReaderId);
+    for (const auto& [Path, TocEntryIndex] : Files) {
+        Insert(Path, TocEntryIndex, ReaderId, mountOrder);
+    }
+}
+
+void VirtualFileSystem::RegisterParallel(const std::vector<std::pair<std::string, uint32_t>>& Files, uint16_t ReaderId) {
+    const uint32_t mountOrder = GetMountOrder(ReaderId);
+    const size_t numThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
     const size_t chunkSize = Files.size() / numThreads;
 
-    std::vector<std::future<phmap::flat_hash_map<uint64_t, FGameFile>>> futures;
+    std::vector<std::future<void>> futures;
 
-    // Divide the files into chunks and process them in parallel
+    // Workers insert straight into the shard each hash picks instead of filling local maps that get merged later
     for (size_t i = 0; i < numThreads; ++i) {
         size_t startIdx = i * chunkSize;
         size_t endIdx = (i == numThreads - 1) ? Files.size() : (i + 1) * chunkSize;
 
-        futures.emplace_back(std::async(std::launch::async, [startIdx, endIdx, &Files]() {
-            phmap::flat_hash_map<uint64_t, FGameFile> localFileMap;
+        futures.emplace_back(std::async(std::launch::async, [this, startIdx, endIdx, &Files, ReaderId, mountOrder]() {
             for (size_t j = startIdx; j < endIdx; ++j) {
-                const auto& [Path, TocEntryIndex] = Files[j];
+                Insert(Files[j].first, Files[j].second, ReaderId, mountOrder);
+            }
+        }));
+    }
 
-                std::string pathWithoutExtension = GetPathWithoutExtension(Path);
-                uint64_t hashedPath = XXH3_64bits(pathWithoutExtension.c_str(), pathWithoutExtension.size());
-                uint32_t extensionId = ExtensionPool::GetOrAdd(GetExtension(Path));
+    for (auto& future : futures) {
+        future.get();
+    }
+}
 
-                auto& file = localFileMap[hashedPath];
-                file.Extensions.emplace_back(extensionId, TocEntryIndex);
+// Splits [0, Count) into one range per hardware thread and runs Body(Index) for every index. Every thread writes
+// its own range of the output, so there's nothing to merge afterwards.
+template <typename FBody>
+static void ParallelForRanges(size_t Count, const FBody& Body) {
+    const size_t numThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const size_t chunkSize = Count / numThreads;
+
+    std::vector<std::future<void>> futures;
+
+    for (size_t i = 0; i < numThreads; ++i) {
+        size_t startIdx = i * chunkSize;
+        size_t endIdx = (i == numThreads - 1) ? Count : (i + 1) * chunkSize;
+
+        futures.emplace_back(std::async(std::launch::async, [startIdx, endIdx, &Body]() {
+            for (size_t j = startIdx; j < endIdx; ++j) {
+                Body(j);
             }
-            return localFileMap;
         }));
     }
 
-    // Merge the results into the global file map
     for (auto& future : futures) {
-        phmap::flat_hash_map<uint64_t, FGameFile> localFileMap = future.get();
-        std::unique_lock<std::shared_mutex> lock(s_VFSMutex);
-        for (const auto& [key, localFile] : localFileMap) {
-            auto& globalFile = s_FileMap[key];
-            globalFile.Extensions.insert(
-                globalFile.Extensions.end(),
-                localFile.Extensions.begin(),
-                localFile.Extensions.end()
-            );
+        future.get();
+    }
+}
+
+FHashedGameFile VirtualFileSystem::HashFile(std::string_view Path, uint32_t TocEntryIndex) {
+    FHashedGameFile hashedFile;
+    hashedFile.TocEntryIndex = TocEntryIndex;
+
+    uint32_t extensionId = ExtensionPool::GetOrAdd(GetExtension(Path));
+    if (extensionId == ExtensionPool::InvalidId) {
+        hashedFile.PathHash = 0;
+        hashedFile.ExtensionId = FHashedGameFile::InvalidExtensionId;
+        return hashedFile;
+    }
+
+    hashedFile.PathHash = HashPathWithoutExtension(Path);
+    hashedFile.ExtensionId = static_cast<uint16_t>(extensionId);
+    return hashedFile;
+}
+
+// Drops the files HashFile couldn't give an extension id, they'd index past the extension pool
+static void RemoveUnpooledFiles(std::vector<FHashedGameFile>& Files) {
+    const size_t skipped = std::erase_if(Files, [](const FHashedGameFile& file) {
+        return file.ExtensionId == FHashedGameFile::InvalidExtensionId;
+    });
+    if (skipped) {
+        LOG_WARN("Skipped {0} files whose extension doesn't fit in the extension pool", skipped);
+    }
+}
+
+void VirtualFileSystem::HashFiles(const std::vector<std::pair<std::string, uint32_t>>& Files, std::vector<FHashedGameFile>& OutFiles) {
+    OutFiles.resize(Files.size());
+
+    ParallelForRanges(Files.size(), [&Files, &OutFiles](size_t Index) {
+        OutFiles[Index] = HashFile(Files[Index].first, Files[Index].second);
+    });
+
+    RemoveUnpooledFiles(OutFiles);
+}
+
+void VirtualFileSystem::HashFiles(const FIoStoreReader& Reader, std::vector<FHashedGameFile>& OutFiles) {
+    struct FPackedPath {
+        size_t Offset;
+        uint32_t Length;
+        uint32_t TocEntryIndex;
+    };
+
+    // The visited paths live in a buffer that's reused for the next file, so they're copied back to back into one
+    // string instead of one allocation per file
+    std::string pathBuffer;
+    std::vector<FPackedPath> packedPaths;
+    packedPaths.reserve(Reader.GetChunkCount());
+
+    Reader.GetDirectoryIndexReader().IterateFiles(
+        FIoDirectoryIndexHandle::RootDirectory(),
+        [&pathBuffer, &packedPaths](const FIoDirectoryIndexFile& File) -> bool {
+            packedPaths.push_back({ pathBuffer.size(), static_cast<uint32_t>(File.Path.size()), File.TocEntryIndex });
+            pathBuffer.append(File.Path);
+            return true;
+        });
+
+    OutFiles.resize(packedPaths.size());
+
+    ParallelForRanges(packedPaths.size(), [&pathBuffer, &packedPaths, &OutFiles](size_t Index) {
+        const FPackedPath& packedPath = packedPaths[Index];
+        OutFiles[Index] = HashFile(std::string_view(pathBuffer).substr(packedPath.Offset, packedPath.Length), packedPath.TocEntryIndex);
+    });
+
+    RemoveUnpooledFiles(OutFiles);
+}
+
+void VirtualFileSystem::RegisterHashed(const std::vector<FHashedGameFile>& Files, uint16_t ReaderId) {
+    const uint32_t mountOrder = GetMountOrder(ReaderId);
+
+    // Bucketed by shard first, so every shard is locked and grown once for the whole container
+    std::array<uint32_t, NumShards + 1> shardStarts = {};
+    for (const FHashedGameFile& hashedFile : Files) {
+        shardStarts[GetShardIndex(hashedFile.PathHash) + 1]++;
+    }
+    for (uint32_t i = 0; i < NumShards; i++) {
+        shardStarts[i + 1] += shardStarts[i];
+    }
+
+    std::vector<uint32_t> order(Files.size());
+    std::array<uint32_t, NumShards> shardCursors;
+    std::copy_n(shardStarts.begin(), NumShards, shardCursors.begin());
+    for (uint32_t i = 0; i < Files.size(); i++) {
+        order[shardCursors[GetShardIndex(Files[i].PathHash)]++] = i;
+    }
+
+    for (uint32_t shardIndex = 0; shardIndex < NumShards; shardIndex++) {
+        const uint32_t count = shardStarts[shardIndex + 1] - shardStarts[shardIndex];
+        if (count == 0) {
+            continue;
+        }
+
+        FFileShard& shard = s_FileShards[shardIndex];
+        std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+        shard.FirstEntries.reserve(shard.FirstEntries.size() + count);
+        shard.Entries.reserve(shard.Entries.size() + count);
+        shard.MountOrders.reserve(shard.MountOrders.size() + count);
+        shard.NextEntries.reserve(shard.NextEntries.size() + count);
+
+        for (uint32_t i = shardStarts[shardIndex]; i < shardStarts[shardIndex + 1]; i++) {
+            const FHashedGameFile& hashedFile = Files[order[i]];
+            shard.Add(hashedFile.PathHash, { ReaderId, hashedFile.ExtensionId, hashedFile.TocEntryIndex }, mountOrder);
         }
     }
 }
 
-void VirtualFileSystem::RegisterReader(FIoStoreReader* Reader) {
+uint16_t VirtualFileSystem::RegisterReader(FIoStoreReader* Reader, uint32_t MountOrder) {
     std::unique_lock<std::shared_mutex> lock(s_VFSMutex);
     s_Readers.push_back(Reader);
+    s_ReaderMountOrders.push_back(MountOrder);
+    return static_cast<uint16_t>(s_Readers.size() - 1);
 }
 
 void VirtualFileSystem::RegisterReaders(std::vector<FIoStoreReader*>& Readers) {
     std::unique_lock<std::shared_mutex> lock(s_VFSMutex);
     for (auto& Reader : Readers) {
         s_Readers.push_back(Reader);
+        s_ReaderMountOrders.push_back(0);
     }
 }
 
 void VirtualFileSystem::Clear() {
+    // Gives the memory back as well, an unmount is usually followed by a mount of a different set of containers
+    for (FFileShard& shard : s_FileShards) {
+        std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+        phmap::flat_hash_map<uint64_t, uint32_t>().swap(shard.FirstEntries);
+        phmap::flat_hash_map<uint64_t, uint32_t>().swap(shard.FirstShadowed);
+        std::vector<FGameFileEntry>().swap(shard.Entries);
+        std::vector<uint32_t>().swap(shard.MountOrders);
+        std::vector<uint32_t>().swap(shard.NextEntries);
+    }
+
     std::unique_lock<std::shared_mutex> lock(s_VFSMutex);
-    s_FileMap.clear();
     s_Readers.clear();
+    s_ReaderMountOrders.clear();
 }
 
 std::optional<FGameFile> VirtualFileSystem::GetFileByPath(const std::string& Path) {
-    std::shared_lock<std::shared_mutex> lock(s_VFSMutex);
+    uint64_t hashedPath = HashPathWithoutExtension(Path);
 
-    std::string pathWithoutExtension = GetPathWithoutExtension(Path);
-    uint64_t hashedPath = XXH3_64bits(pathWithoutExtension.c_str(), pathWithoutExtension.size());
+    const FFileShard& shard = s_FileShards[GetShardIndex(hashedPath)];
+    std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+    auto it = shard.FirstEntries.find(hashedPath);
+    if (it == shard.FirstEntries.end()) {
+        return std::nullopt;
+    }
 
-    auto it = s_FileMap.find(hashedPath);
-    if (it != s_FileMap.end()) {
-        return it->second;
+    FGameFile file;
+    for (uint32_t entryIndex = it->second; entryIndex != InvalidEntryIndex; entryIndex = shard.NextEntries[entryIndex]) {
+        file.Extensions.push_back(shard.Entries[entryIndex]);
     }
-    return std::nullopt;
-}
 
-TIoStatusOr<FIoBuffer> VirtualFileSystem::GetBufferByPathAndExtension(const std::string& Path) {
-    std::optional<FGameFile> fileStatus = VirtualFileSystem::GetFileByPath(Path);
-    if (!fileStatus.has_value()) {
-        LOG_ERROR("File '{0}' has not been registered!", Path);
-        return FIoStatus(EIoErrorCode::NotFound, "Provided file not registered.");
+    auto shadowedIt = shard.FirstShadowed.find(hashedPath);
+    if (shadowedIt != shard.FirstShadowed.end()) {
+        for (uint32_t entryIndex = shadowedIt->second; entryIndex != InvalidEntryIndex; entryIndex = shard.NextEntries[entryIndex]) {
+            file.Shadowed.push_back(shard.Entries[entryIndex]);
+        }
     }
+    return file;
+}
 
-    FGameFile& file = fileStatus.value();
-    uint32_t extensionId = ExtensionPool::GetOrAdd(GetExtension(Path));
+TIoStatusOr<FGameFileEntry> VirtualFileSystem::FindEntry(const std::string& Path) {
+    uint64_t hashedPath = HashPathWithoutExtension(Path);
+    std::string_view extension = GetExtension(Path);
 
-    auto it = std::find_if(file.Extensions.begin(), file.Extensions.end(),
-        [extensionId](const auto& pair) { return pair.first == extensionId; });
+    // An extension the pool has never seen can't have been registered, and looking it up shouldn't add it
+    uint32_t extensionId = ExtensionPool::Find(extension);
 
-    if (it == file.Extensions.end()) {
-        LOG_ERROR("File '{0}' has not been registered with extension '{1}!", Path, ExtensionPool::Get(extensionId));
-        return FIoStatus(EIoErrorCode::NotFound, "Provided file not registered with extension.");
+    {
+        const FFileShard& shard = s_FileShards[GetShardIndex(hashedPath)];
+        std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+        auto it = shard.FirstEntries.find(hashedPath);
+        if (it == shard.FirstEntries.end()) {
+            LOG_ERROR("File '{0}' has not been registered!", Path);
+            return FIoStatus(EIoErrorCode::NotFound, "Provided file not registered.");
+        }
+
+        for (uint32_t entryIndex = it->second; entryIndex != InvalidEntryIndex; entryIndex = shard.NextEntries[entryIndex]) {
+            if (shard.Entries[entryIndex].ExtensionId == extensionId) {
+                return shard.Entries[entryIndex];
+            }
+        }
     }
 
-    const uint32_t TocEntryIndex = it->second;
-    for (auto& Reader : s_Readers) {
-        TIoStatusOr<FIoStoreTocChunkInfo> chunkStatus = Reader->GetChunkInfo(TocEntryIndex);
-        if (!chunkStatus.IsOk()) continue;
+    LOG_ERROR("File '{0}' has not been registered with extension '{1}!", Path, extension);
+    return FIoStatus(EIoErrorCode::NotFound, "Provided file not registered with extension.");
+}
 
-        FIoStoreTocChunkInfo chunkInfo = chunkStatus.ConsumeValueOrDie();
-        if (NormalizeFilePath(chunkInfo.FileName) != NormalizeFilePath(Path)) continue;
+FIoStoreReader* VirtualFileSystem::GetReader(uint16_t ReaderId) {
+    std::shared_lock<std::shared_mutex> lock(s_VFSMutex);
+    return ReaderId < s_Readers.size() ? s_Readers[ReaderId] : nullptr;
+}
 
-        return Reader->Read(chunkInfo.Id, FIoReadOptions(0, chunkInfo.Size));
-    }
-    LOG_ERROR("File '{0}' does not exist in registered readers!", Path);
-    return FIoStatus(EIoErrorCode::NotFound, "Provided file does not exist in registered readers.");
+uint32_t VirtualFileSystem::GetMountOrder(uint16_t ReaderId) {
+    std::shared_lock<std::shared_mutex> lock(s_VFSMutex);
+    return ReaderId < s_ReaderMountOrders.size() ? s_ReaderMountOrders[ReaderId] : 0;
 }
 
-FIoStoreReader* VirtualFileSystem::GetReaderByPathAndExtension(const std::string& Path) {
-    std::optional<FGameFile> fileStatus = VirtualFileSystem::GetFileByPath(Path);
-    if (!fileStatus.has_value()) {
-        LOG_ERROR("File '{0}' has not been registered!", Path);
-        return nullptr;
+TIoStatusOr<FIoBuffer> VirtualFileSystem::GetBufferByPathAndExtension(const std::string& Path) {
+    TIoStatusOr<FGameFileEntry> entryStatus = FindEntry(Path);
+    if (!entryStatus.IsOk()) {
+        return entryStatus.Status();
     }
 
-    FGameFile& file = fileStatus.value();
-    uint32_t extensionId = ExtensionPool::GetOrAdd(GetExtension(Path));
+    const FGameFileEntry entry = entryStatus.ConsumeValueOrDie();
+    FIoStoreReader* Reader = GetReader(entry.ReaderId);
+    if (!Reader) {
+        LOG_ERROR("File '{0}' does not exist in registered readers!", Path);
+        return FIoStatus(EIoErrorCode::NotFound, "Provided file does not exist in registered readers.");
+    }
 
-    auto it = std::find_if(file.Extensions.begin(), file.Extensions.end(),
-        [extensionId](const auto& pair) { return pair.first == extensionId; });
+    const FIoStoreTocResource& TocResource = Reader->GetTocResource();
+    return Reader->Read(TocResource.ChunkIds[entry.TocEntryIndex], FIoReadOptions(0, TocResource.ChunkOffsetAndLengths[entry.TocEntryIndex].GetLength()));
+}
 
-    if (it == file.Extensions.end()) {
-        LOG_ERROR("File '{0}' has not been registered with extension '{1}!", Path, ExtensionPool::Get(extensionId));
+FIoStoreReader* VirtualFileSystem::GetReaderByPathAndExtension(const std::string& Path) {
+    TIoStatusOr<FGameFileEntry> entryStatus = FindEntry(Path);
+    if (!entryStatus.IsOk()) {
         return nullptr;
     }
 
-    const uint32_t TocEntryIndex = it->second;
-    for (auto& Reader : s_Readers) {
-        TIoStatusOr<FIoStoreTocChunkInfo> chunkStatus = Reader->GetChunkInfo(TocEntryIndex);
-        if (!chunkStatus.IsOk()) continue;
-
-        FIoStoreTocChunkInfo chunkInfo = chunkStatus.ConsumeValueOrDie();
-        if (NormalizeFilePath(chunkInfo.FileName) != NormalizeFilePath(Path)) continue;
-
-        return Reader;
-    }
-    LOG_ERROR("File '{0}' does not exist in registered readers!", Path);
-    return nullptr;
+    return GetReader(entryStatus.ConsumeValueOrDie().ReaderId);
 }
 
 uint32_t VirtualFileSystem::GetTocEntryIndexByPathAndExtension(const std::string& Path) {
-    std::optional<FGameFile> fileStatus = VirtualFileSystem::GetFileByPath(Path);
-    if (!fileStatus.has_value()) {
-        LOG_ERROR("File '{0}' has not been registered!", Path);
+    TIoStatusOr<FGameFileEntry> entryStatus = FindEntry(Path);
+    if (!entryStatus.IsOk()) {
         return 0;
     }
 
-    FGameFile& file = fileStatus.value();
-    uint32_t extensionId = ExtensionPool::GetOrAdd(GetExtension(Path));
+    return entryStatus.ConsumeValueOrDie().TocEntryIndex;
+}
 
-    auto it = std::find_if(file.Extensions.begin(), file.Extensions.end(),
-        [extensionId](const auto& pair) { return pair.first == extensionId; });
+// Where the file name starts. Both slashes separate components, as they do for std::filesystem on Windows.
+static size_t FindFileNameStart(std::string_view path) {
+    size_t separator = path.find_last_of("/\\");
+    return separator == std::string_view::npos ? 0 : separator + 1;
+}
 
-    if (it == file.Extensions.end()) {
-        LOG_ERROR("File '{0}' has not been registered with extension '{1}!", Path, ExtensionPool::Get(extensionId));
-        return 0;
+// Splits a file name into stem and extension like std::filesystem does: the extension starts at the last dot,
+// except for "." and ".." and names whose only dot is the first character.
+static size_t FindExtensionStart(std::string_view fileName) {
+    if (fileName.size() <= 1 || fileName == "..") {
+        return fileName.size();
     }
 
-    const uint32_t TocEntryIndex = it->second;
-    for (auto& Reader : s_Readers) {
-        TIoStatusOr<FIoStoreTocChunkInfo> chunkStatus = Reader->GetChunkInfo(TocEntryIndex);
-        if (!chunkStatus.IsOk()) continue;
-
-        FIoStoreTocChunkInfo chunkInfo = chunkStatus.ConsumeValueOrDie();
-        if (NormalizeFilePath(chunkInfo.FileName) != NormalizeFilePath(Path)) continue;
-
-        return TocEntryIndex;
-    }
+    size_t dot = fileName.find_last_of('.');
+    return dot == std::string_view::npos || dot == 0 ? fileName.size() : dot;
 }
 
-std::string VirtualFileSystem::GetExtension(const std::string& Path) {
-    return std::filesystem::path(Path).extension().string();
+std::string_view VirtualFileSystem::GetExtension(std::string_view Path) {
+    std::string_view fileName = Path.substr(FindFileNameStart(Path));
+    return fileName.substr(FindExtensionStart(fileName));
 }
 
-std::string VirtualFileSystem::GetPathWithoutExtension(const std::string& Path) {
-    std::filesystem::path fsPath(Path);
-    fsPath.make_preferred();
-    return NormalizeFilePath(fsPath.parent_path().string() + "\\" + fsPath.stem().string());
-}
+static constexpr std::string_view InternalGameName = "fortnitegame";
+static constexpr std::string_view PluginRoot = "fortnitegame/plugins/gamefeatures/";
+static constexpr std::string_view PluginContent = "/content/";
+
+// Normalizes the directory and stem of Path in one pass over it and hands the result to Callback. Components are
+// written after some headroom in one buffer, so the game name and plugin prefixes can be put in front of them in
+// place. This has to produce exactly what the file map has always been keyed by, quirks included:
+//  - "." and empty components are dropped, ".." drops the previous component
+//  - a last component like "Name.Name" becomes "Name", or "Name.Name/Name" when it's the only component
+//  - everything is lowercased
+//  - "game/..." and "engine/..." are mapped into fortnitegame and engine, content/ is added unless the path
+//    already goes to content, config or plugins. Anything not under fortnitegame is a game feature plugin.
+template <typename FCallback>
+static auto VisitPathWithoutExtension(std::string_view path, FCallback&& callback) {
+    // The components take at most 1.5x the path (the "Name.Name/Name" case), the headroom has to fit the plugin
+    // prefixes plus a copy of the root when the root is also the whole tree
+    const size_t headroom = PluginRoot.size() + PluginContent.size() + path.size();
+    const size_t capacity = headroom + path.size() * 2 + 2;
+
+    char stackBuffer[2048];
+    std::unique_ptr<char[]> heapBuffer;
+    char* buffer = stackBuffer;
+    if (capacity > sizeof(stackBuffer)) {
+        heapBuffer = std::make_unique<char[]>(capacity);
+        buffer = heapBuffer.get();
+    }
 
-static const std::string InternalGameName = "fortnitegame";
-std::string VirtualFileSystem::NormalizeFilePath(const std::string& path) {
-    std::string normalizedPath = path;
-    std::replace(normalizedPath.begin(), normalizedPath.end(), '\\', '/');
+    const size_t start = headroom;
+    size_t end = start;
 
-    if (!normalizedPath.empty() && normalizedPath[0] == '/') {
-        normalizedPath = normalizedPath.substr(1);
-    }
+    auto pushComponent = [buffer, start, &end](std::string_view component) {
+        if (component.empty() || component == ".") {
+            return;
+        }
 
-    std::vector<std::string> components;
-    std::istringstream stream(normalizedPath);
-    std::string segment;
-    while (std::getline(stream, segment, '/')) {
-        if (segment == "..") {
-            if (!components.empty()) {
-                components.pop_back();
+        if (component == "..") {
+            while (end > start && buffer[end - 1] != '/') {
+                end--;
+            }
+            if (end > start) {
+                end--;
             }
+            return;
         }
-        else if (!segment.empty() && segment != ".") {
-            components.push_back(segment);
+
+        if (end > start) {
+            buffer[end++] = '/';
         }
+        memcpy(buffer + end, component.data(), component.size());
+        end += component.size();
+    };
+
+    const size_t fileNameStart = FindFileNameStart(path);
+    for (size_t componentStart = 0; componentStart < fileNameStart;) {
+        size_t separator = path.find_first_of("/\\", componentStart);
+        pushComponent(path.substr(componentStart, separator - componentStart));
+        componentStart = separator + 1;
     }
 
-    std::string result;
-    for (const auto& comp : components) {
-        if (!result.empty()) {
-            result += "/";
+    std::string_view fileName = path.substr(fileNameStart);
+    pushComponent(fileName.substr(0, FindExtensionStart(fileName)));
+
+    // "Name.Name" collapses to "Name", compared before lowercasing
+    std::string_view components(buffer + start, end - start);
+    size_t lastSlash = components.find_last_of('/');
+    size_t lastPartStart = lastSlash == std::string_view::npos ? 0 : lastSlash + 1;
+    std::string_view lastPart = components.substr(lastPartStart);
+    size_t dot = lastPart.find('.');
+    if (dot != std::string_view::npos && lastPart.substr(0, dot) == lastPart.substr(dot + 1)) {
+        if (lastSlash != std::string_view::npos) {
+            end = start + lastPartStart + dot;
+        }
+        else {
+            buffer[end] = '/';
+            memcpy(buffer + end + 1, buffer + start, dot);
+            end += dot + 1;
         }
-        result += comp;
     }
 
-    std::string lastPart = result.substr(result.find_last_of("/") + 1);
-    if (lastPart.find('.') != std::string::npos && lastPart.substr(0, lastPart.find('.')) == lastPart.substr(lastPart.find('.') + 1)) {
-        result = result.substr(0, result.find_last_of("/")) + "/" + lastPart.substr(0, lastPart.find('.'));
+    for (size_t i = start; i < end; i++) {
+        if (buffer[i] >= 'A' && buffer[i] <= 'Z') {
+            buffer[i] += 'a' - 'A';
+        }
     }
 
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    components = std::string_view(buffer + start, end - start);
+    size_t firstSlash = components.find('/');
+    size_t rootSize = firstSlash == std::string_view::npos ? components.size() : firstSlash;
+    size_t treeStart = firstSlash == std::string_view::npos ? start : start + firstSlash + 1;
+    std::string_view root = components.substr(0, rootSize);
 
-    std::string root = result.substr(0, result.find('/'));
-    std::string tree = result.substr(result.find('/') + 1);
+    auto prepend = [buffer](size_t& at, std::string_view text) {
+        at -= text.size();
+        memcpy(buffer + at, text.data(), text.size());
+    };
 
+    size_t resultStart = start;
     if (root == "game" || root == "engine") {
-        std::string gameName = (root == "engine") ? "engine" : InternalGameName;
-        std::string root2 = tree.substr(0, tree.find('/'));
-        if (root2 == "config" || root2 == "content" || root2 == "plugins") {
-            result = gameName + "/" + tree;
+        // Root is overwritten by the prefix, so everything read from it comes first
+        std::string_view gameName = root == "engine" ? "engine" : InternalGameName;
+        std::string_view tree(buffer + treeStart, end - treeStart);
+        std::string_view root2 = tree.substr(0, tree.find('/'));
+
+        resultStart = treeStart;
+        if (root2 != "config" && root2 != "content" && root2 != "plugins") {
+            prepend(resultStart, "content/");
         }
-        else {
-            result = gameName + "/content/" + tree;
-        }
-    }
-    else if (root == InternalGameName) {
-        // Everything is fine, no changes needed
+        prepend(resultStart, "/");
+        prepend(resultStart, gameName);
     }
-    else if (InternalGameName == "fortnitegame") {
-        result = InternalGameName + "/plugins/gamefeatures/" + root + "/content/" + tree;
+    else if (root != InternalGameName) {
+        // Root moves in front of "/content/", when there's no tree the root is also the tree and stays where it is
+        size_t rootStart = firstSlash == std::string_view::npos ? start - PluginContent.size() - rootSize : start - (PluginContent.size() - 1);
+        memmove(buffer + rootStart, buffer + start, rootSize);
+        memcpy(buffer + rootStart + rootSize, PluginContent.data(), PluginContent.size());
+
+        resultStart = rootStart;
+        prepend(resultStart, PluginRoot);
     }
 
-    return result;
+    return callback(std::string_view(buffer + resultStart, end - resultStart));
 }
 
-void VirtualFileSystem::PrintRegisteredFiles() {
-    std::shared_lock<std::shared_mutex> lock(s_VFSMutex);
+std::string VirtualFileSystem::GetPathWithoutExtension(const std::string& Path) {
+    return VisitPathWithoutExtension(Path, [](std::string_view normalizedPath) {
+        return std::string(normalizedPath);
+    });
+}
 
-    for (const auto& [path, file] : s_FileMap) {
-        std::string extensions;
-        for (const auto& [extId, tocIdx] : file.Extensions) {
-            extensions.append("(" + ExtensionPool::Get(extId) + "[" + std::to_string(tocIdx) + "]) ");
+uint64_t VirtualFileSystem::HashPathWithoutExtension(std::string_view Path) {
+    return VisitPathWithoutExtension(Path, [](std::string_view normalizedPath) {
+        return XXH3_64bits(normalizedPath.data(), normalizedPath.size());
+    });
+}
+
+void VirtualFileSystem::PrintRegisteredFiles() {
+    for (const FFileShard& shard : s_FileShards) {
+        std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+
+        for (const auto& [path, firstIndex] : shard.FirstEntries) {
+            std::string extensions;
+            for (uint32_t entryIndex = firstIndex; entryIndex != InvalidEntryIndex; entryIndex = shard.NextEntries[entryIndex]) {
+                const FGameFileEntry& entry = shard.Entries[entryIndex];
+                extensions.append("(" + ExtensionPool::Get(entry.ExtensionId) + "[" + std::to_string(entry.ReaderId) + ":" + std::to_string(entry.TocEntryIndex) + "]) ");
+            }
+            LOG_INFO("Path: {0}, Extensions: [ {1}]", path, extensions);
         }
-        LOG_INFO("Path: {0}, Extensions: [ {1}]", path, extensions);
     }
 }
+
+FVfsMemoryStats VirtualFileSystem::GetMemoryStats() const {
+    // A flat table slot is the key/value pair plus one control byte
+    static constexpr uint64_t tableSlotSize = sizeof(phmap::flat_hash_map<uint64_t, uint32_t>::value_type) + 1;
+
+    FVfsMemoryStats stats;
+    for (const FFileShard& shard : s_FileShards) {
+        std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+        stats.Files += shard.FirstEntries.size();
+        stats.Entries += shard.Entries.size();
+        stats.TableBytes += (shard.FirstEntries.capacity() + shard.FirstShadowed.capacity()) * tableSlotSize;
+        stats.EntryBytes += shard.Entries.capacity() * sizeof(FGameFileEntry)
+            + (shard.MountOrders.capacity() + shard.NextEntries.capacity()) * sizeof(uint32_t);
+    }
+    return stats;
+}
@@ -6,53 +6,141 @@ export module Saturn.VFS.FileSystem;
 
 import <string>;
 import <vector>;
+import <array>;
+import <cstdint>;
 import <optional>;
+import <string_view>;
 import <shared_mutex>;
 
 import Saturn.Core.IoStatus;
 import Saturn.Misc.IoBuffer;
 import Saturn.Structs.IoChunkId;
 
-// A global extension pool to deduplicate extension strings
+// A global extension pool to deduplicate extension strings. Lookups are lock-free and safe from any thread,
+// only adding an extension that hasn't been seen before takes a lock. The common Unreal extensions are added
+// up front so they get the same ids in every process, and ids always fit in a byte.
 export class ExtensionPool {
 public:
-    static uint32_t GetOrAdd(const std::string& extension);
+    static constexpr uint32_t MaxExtensions = 256;
+    static constexpr uint32_t InvalidId = ~uint32_t(0);
+
+    static uint32_t GetOrAdd(std::string_view extension); // InvalidId once the pool is full
+    static uint32_t Find(std::string_view extension);     // InvalidId if it was never added
     static const std::string& Get(uint32_t id);
+    static uint32_t Num();
+};
 
-private:
-    static inline phmap::flat_hash_map<std::string, uint32_t> s_Pool;
-    static inline std::vector<std::string> s_ReverseLookup;
+// One file of a package inside one container. ReaderId indexes the registered readers, so resolving
+// an entry never needs to ask the readers which of them owns the TOC index.
+export struct FGameFileEntry {
+    uint16_t ReaderId;
+    uint16_t ExtensionId; // ID from ExtensionPool
+    uint32_t TocEntryIndex;
+};
+
+// A file whose path was already normalized and hashed, what the mount snapshot stores per container
+export struct FHashedGameFile {
+    // Set by HashFile when the extension pool is full, HashFiles leaves those files out
+    static constexpr uint16_t InvalidExtensionId = 0xFFFF;
+
+    uint64_t PathHash;
+    uint32_t TocEntryIndex;
+    uint16_t ExtensionId;
+    uint16_t Padding = 0;
 };
 
+// Every entry registered under one path, gathered from the file map on request. Extensions holds the one
+// entry per extension that lookups resolve to, Shadowed what containers with a higher mount order overrode.
 export struct FGameFile {
-    // Extensions are stored as IDs from ExtensionPool
-    std::vector<std::pair<uint32_t, uint32_t>> Extensions; // <ExtensionID, TocEntryIndex>
+    std::vector<FGameFileEntry> Extensions;
+    std::vector<FGameFileEntry> Shadowed;
+};
+
+// What the file map holds on to, counted by allocated capacity rather than what is in use
+export struct FVfsMemoryStats {
+    uint64_t Files = 0;
+    uint64_t Entries = 0;
+    uint64_t TableBytes = 0; // Path hash to first entry and first shadowed entry tables
+    uint64_t EntryBytes = 0; // Entry arrays and their chain links
+
+    uint64_t GetTotalBytes() const { return TableBytes + EntryBytes; }
+    double GetBytesPerFile() const { return Files ? static_cast<double>(GetTotalBytes()) / Files : 0.0; }
 };
 
 export class VirtualFileSystem {
 public:
-    void Register(const std::string& Path, uint32_t TocEntryIndex);
-    void RegisterBatch(const std::vector<std::pair<std::string, uint32_t>>& Files);
-    void RegisterParallel(const std::vector<std::pair<std::string, uint32_t>>& Files);
-
-    void RegisterReader(class FIoStoreReader* Reader);
+    // Readers have to be registered before their files, the returned id is what the files refer to. When more than
+    // one container has the same file, the one with the higher mount order wins no matter which registers first,
+    // on equal mount orders the file registered first stays.
+    uint16_t RegisterReader(class FIoStoreReader* Reader, uint32_t MountOrder = 0);
     void RegisterReaders(std::vector<class FIoStoreReader*>& Readers);
 
+    void Register(const std::string& Path, uint32_t TocEntryIndex, uint16_t ReaderId);
+    void RegisterBatch(const std::vector<std::pair<std::string, uint32_t>>& Files, uint16_t ReaderId);
+    void RegisterParallel(const std::vector<std::pair<std::string, uint32_t>>& Files, uint16_t ReaderId);
+    void RegisterHashed(const std::vector<FHashedGameFile>& Files, uint16_t ReaderId);
+
+    // Normalizes and hashes every path on all cores, OutFiles is in the same order as Files. Files whose extension
+    // doesn't fit in the extension pool are logged and left out.
+    static void HashFiles(const std::vector<std::pair<std::string, uint32_t>>& Files, std::vector<FHashedGameFile>& OutFiles);
+
+    // Same as above for every file in Reader's directory index, hashed straight from the index without a string per file
+    static void HashFiles(const class FIoStoreReader& Reader, std::vector<FHashedGameFile>& OutFiles);
+
+    // Path hash and extension id of one file, what HashFiles computes for every entry. ExtensionId is
+    // FHashedGameFile::InvalidExtensionId if the extension pool is full.
+    static FHashedGameFile HashFile(std::string_view Path, uint32_t TocEntryIndex);
+
     void Clear();
 
     void PrintRegisteredFiles();
+    FVfsMemoryStats GetMemoryStats() const;
     std::optional<FGameFile> GetFileByPath(const std::string& Path);
     TIoStatusOr<FIoBuffer> GetBufferByPathAndExtension(const std::string& Path);
     class FIoStoreReader* GetReaderByPathAndExtension(const std::string& Path);
     uint32_t GetTocEntryIndexByPathAndExtension(const std::string& Path);
 
-private:
-    static std::string GetExtension(const std::string& Path);
+    // Normalized path without its extension, identical for every file of a package
     static std::string GetPathWithoutExtension(const std::string& Path);
-    static std::string NormalizeFilePath(const std::string& path);
 
-    // Key is xxhashed normalized path
-    TMap<uint64_t, FGameFile> s_FileMap;
+    // XXH3 of GetPathWithoutExtension(Path), what the file map is keyed by. Doesn't allocate for normal length paths.
+    static uint64_t HashPathWithoutExtension(std::string_view Path);
+private:
+    TIoStatusOr<FGameFileEntry> FindEntry(const std::string& Path);
+    class FIoStoreReader* GetReader(uint16_t ReaderId);
+    uint32_t GetMountOrder(uint16_t ReaderId);
+
+    static std::string_view GetExtension(std::string_view Path);
+
+    static constexpr uint32_t NumShards = 64;
+    static constexpr uint32_t InvalidEntryIndex = ~uint32_t(0);
+
+    // Files are sharded on the path hash and every shard has its own reader/writer lock, so lookups only lock
+    // the shard they land in. Within a shard the tables only map a path hash to the index of its first entry,
+    // the entries of all its files share one array and are chained through NextEntries. Overrides are resolved
+    // when an entry is added, so the FirstEntries chain only has the winning entry of every extension and the
+    // entries they shadow are chained from FirstShadowed.
+    struct alignas(64) FFileShard {
+        mutable std::shared_mutex Mutex;
+        phmap::flat_hash_map<uint64_t, uint32_t> FirstEntries;
+        phmap::flat_hash_map<uint64_t, uint32_t> FirstShadowed;
+        std::vector<FGameFileEntry> Entries;
+        std::vector<uint32_t> MountOrders;
+        std::vector<uint32_t> NextEntries;
+
+        void Add(uint64_t PathHash, const FGameFileEntry& Entry, uint32_t MountOrder); // Caller holds the lock
+    };
+
+    static uint32_t GetShardIndex(uint64_t PathHash) { return static_cast<uint32_t>(PathHash >> 58); }
+
+    void Insert(uint64_t PathHash, const FGameFileEntry& Entry, uint32_t MountOrder);
+    void Insert(const std::string& Path, uint32_t TocEntryIndex, uint16_t ReaderId, uint32_t MountOrder);
+
+    // Picked by the top bits of the xxhashed normalized path
+    std::array<FFileShard, NumShards> s_FileShards;
+
+    // Only guards the readers, the shards lock themselves
     std::shared_mutex s_VFSMutex;
     std::vector<class FIoStoreReader*> s_Readers;
+    std::vector<uint32_t> s_ReaderMountOrders;
 };
\ No newline at end of file